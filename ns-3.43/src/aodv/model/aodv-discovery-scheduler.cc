@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "aodv-discovery-scheduler.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AodvDiscoveryScheduler");
+
+namespace aodv {
+
+/// Tolerance of the token count, against rounding of the refill time
+static const double TOKEN_EPSILON = 1e-9;
+
+DiscoveryScheduler::DiscoveryScheduler ()
+  : m_rate (0),
+    m_tokens (0),
+    m_lastRefill (Seconds (0)),
+    m_timer (Timer::CANCEL_ON_DESTROY),
+    m_timerAt (Seconds (0)),
+    m_serving (false)
+{
+  m_timer.SetFunction (&DiscoveryScheduler::TimerExpire, this);
+}
+
+void
+DiscoveryScheduler::SetRateLimit (uint32_t rreqPerSecond)
+{
+  m_rate = rreqPerSecond;
+  m_tokens = rreqPerSecond;
+  m_lastRefill = Simulator::Now ();
+}
+
+void
+DiscoveryScheduler::Schedule (Ipv4Address dst, Time delay)
+{
+  NS_LOG_FUNCTION (this << dst << delay);
+  Time at = Simulator::Now () + delay;
+  std::map<Ipv4Address, Time>::iterator i = m_deadlines.find (dst);
+  if (i != m_deadlines.end ())
+    {
+      m_queue.erase (std::make_pair (i->second, dst));
+      i->second = at;
+    }
+  else
+    {
+      m_deadlines.insert (std::make_pair (dst, at));
+    }
+  m_queue.insert (std::make_pair (at, dst));
+  Arm ();
+}
+
+void
+DiscoveryScheduler::Cancel (Ipv4Address dst)
+{
+  NS_LOG_FUNCTION (this << dst);
+  std::map<Ipv4Address, Time>::iterator i = m_deadlines.find (dst);
+  if (i != m_deadlines.end ())
+    {
+      m_queue.erase (std::make_pair (i->second, dst));
+      m_deadlines.erase (i);
+    }
+}
+
+void
+DiscoveryScheduler::Refill ()
+{
+  Time now = Simulator::Now ();
+  m_tokens = std::min<double> (m_rate, m_tokens + (now - m_lastRefill).GetSeconds () * m_rate);
+  m_lastRefill = now;
+}
+
+bool
+DiscoveryScheduler::ConsumeToken ()
+{
+  if (m_rate == 0)
+    {
+      return true;
+    }
+  // Older deferred RREQs go first
+  if (!m_deferred.empty () && !m_serving)
+    {
+      return false;
+    }
+  Refill ();
+  if (m_tokens < 1 - TOKEN_EPSILON)
+    {
+      return false;
+    }
+  m_tokens = std::max (0.0, m_tokens - 1);
+  return true;
+}
+
+void
+DiscoveryScheduler::Defer (std::vector<Ipv4Address> const & dsts)
+{
+  NS_LOG_FUNCTION (this << dsts.size ());
+  std::vector<Ipv4Address> fresh;
+  for (std::vector<Ipv4Address>::const_iterator d = dsts.begin (); d != dsts.end (); ++d)
+    {
+      if (m_deferredDsts.insert (*d).second)
+        {
+          fresh.push_back (*d);
+        }
+    }
+  if (fresh.empty ())
+    {
+      return;
+    }
+  m_deferred.push_back (fresh);
+  Arm ();
+}
+
+void
+DiscoveryScheduler::Clear ()
+{
+  m_timer.Cancel ();
+  m_deadlines.clear ();
+  m_queue.clear ();
+  m_deferred.clear ();
+  m_deferredDsts.clear ();
+}
+
+void
+DiscoveryScheduler::Arm ()
+{
+  Time now = Simulator::Now ();
+  Time at = Time::Max ();
+  if (!m_queue.empty ())
+    {
+      at = m_queue.begin ()->first;
+    }
+  if (!m_deferred.empty ())
+    {
+      Refill ();
+      Time token = now;
+      if (m_tokens < 1 - TOKEN_EPSILON)
+        {
+          token += std::max (TimeStep (1), Seconds ((1 - m_tokens) / m_rate));
+        }
+      at = std::min (at, token);
+    }
+  if (at == Time::Max ())
+    {
+      return;
+    }
+  at = std::max (at, now);
+  if (m_timer.IsRunning () && m_timerAt <= at)
+    {
+      return;
+    }
+  m_timer.Cancel ();
+  m_timerAt = at;
+  m_timer.Schedule (at - now);
+}
+
+void
+DiscoveryScheduler::TimerExpire ()
+{
+  NS_LOG_FUNCTION (this << m_deferred.size () << m_queue.size ());
+  m_serving = true;
+  while (!m_deferred.empty () && ConsumeToken ())
+    {
+      // The send callback takes its own token
+      m_tokens += 1;
+      std::vector<Ipv4Address> dsts = m_deferred.front ();
+      m_deferred.pop_front ();
+      for (std::vector<Ipv4Address>::const_iterator d = dsts.begin (); d != dsts.end (); ++d)
+        {
+          m_deferredDsts.erase (*d);
+        }
+      m_send (dsts);
+    }
+  m_serving = false;
+  Time now = Simulator::Now ();
+  while (!m_queue.empty () && m_queue.begin ()->first <= now)
+    {
+      Ipv4Address dst = m_queue.begin ()->second;
+      m_queue.erase (m_queue.begin ());
+      m_deadlines.erase (dst);
+      m_retry (dst);
+    }
+  Arm ();
+}
+
+}  // namespace aodv
+}  // namespace ns3
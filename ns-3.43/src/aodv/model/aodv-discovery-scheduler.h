@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AODVDISCOVERYSCHEDULER_H
+#define AODVDISCOVERYSCHEDULER_H
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+#include "ns3/callback.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/timer.h"
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv
+ * \brief Retry deadlines of all route discoveries and the RREQ rate limit
+ *
+ * Deadlines are kept in one ordered queue and a single timer is armed for
+ * the earliest one. RREQs are paced by a token bucket refilled at RateLimit
+ * per second, RREQs without a token wait in a FIFO and are sent, oldest
+ * first, by the same timer as tokens come back.
+ */
+class DiscoveryScheduler
+{
+public:
+  /// constructor
+  DiscoveryScheduler ();
+
+  /**
+   * \param cb called with the destination when its retry deadline is reached
+   */
+  void SetRetryCallback (Callback<void, Ipv4Address> cb) { m_retry = cb; }
+  /**
+   * \param cb called with the destinations of a deferred RREQ once a token is available
+   */
+  void SetSendCallback (Callback<void, std::vector<Ipv4Address> > cb) { m_send = cb; }
+  /**
+   * Set the token bucket rate and depth, a full bucket
+   * \param rreqPerSecond RREQs per second, 0 for no limit
+   */
+  void SetRateLimit (uint32_t rreqPerSecond);
+
+  /**
+   * Set or move the retry deadline of a discovery
+   * \param dst the destination
+   * \param delay time until the retry
+   */
+  void Schedule (Ipv4Address dst, Time delay);
+  /**
+   * Forget the discovery of dst, e.g. on RREP
+   * \param dst the destination
+   */
+  void Cancel (Ipv4Address dst);
+  /**
+   * \param dst the destination
+   * \returns true if a retry of the discovery of dst is scheduled
+   */
+  bool IsPending (Ipv4Address dst) const { return m_deadlines.find (dst) != m_deadlines.end (); }
+  /// \returns the number of scheduled retries
+  uint32_t GetPendingCount () const { return m_deadlines.size (); }
+
+  /**
+   * Take a token for a RREQ
+   * \returns true if the RREQ may be sent now
+   */
+  bool ConsumeToken ();
+  /**
+   * Send a RREQ through the send callback once a token is available.
+   * Destinations already waiting are left out, nothing is queued if none is left.
+   * \param dsts the destinations of the RREQ
+   */
+  void Defer (std::vector<Ipv4Address> const & dsts);
+
+  /// Forget all discoveries and deferred RREQs
+  void Clear ();
+
+private:
+  /// Add the tokens earned since the last refill
+  void Refill ();
+  /// Arm the timer for the earliest deadline or token, if earlier than the armed time
+  void Arm ();
+  /// Timer handler
+  void TimerExpire ();
+
+  /// Retry deadline by destination
+  std::map<Ipv4Address, Time> m_deadlines;
+  /// The same deadlines, earliest first
+  std::set<std::pair<Time, Ipv4Address> > m_queue;
+  /// RREQs waiting for a token, oldest first
+  std::deque<std::vector<Ipv4Address> > m_deferred;
+  /// Destinations of the RREQs in m_deferred
+  std::set<Ipv4Address> m_deferredDsts;
+  /// Token bucket rate and depth
+  uint32_t m_rate;
+  /// Tokens in the bucket
+  double m_tokens;
+  /// Time of the last refill
+  Time m_lastRefill;
+  /// The single timer, and the time it is armed for
+  Timer m_timer;
+  Time m_timerAt;
+  /// Retry callback
+  Callback<void, Ipv4Address> m_retry;
+  /// Send callback
+  Callback<void, std::vector<Ipv4Address> > m_send;
+  /// Deferred RREQs are being sent and may take tokens
+  bool m_serving;
+};
+
+}  // namespace aodv
+}  // namespace ns3
+
+#endif /* AODVDISCOVERYSCHEDULER_H */
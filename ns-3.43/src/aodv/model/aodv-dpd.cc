@@ -21,19 +21,182 @@
  */
 
 #include "aodv-dpd.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
 
 namespace ns3 {
 namespace aodv {
 
+/// 64 bit finalizer of MurmurHash3
+static uint64_t
+Mix64 (uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+RotatingBloomFilter::RotatingBloomFilter (uint32_t memory, double falsePositiveRate, Time lifetime)
+  : m_current (0),
+    m_lifetime (lifetime),
+    m_rotated (Simulator::Now ()),
+    m_lookups (0),
+    m_positives (0),
+    m_earlyRotations (0),
+    m_estimatedFalsePositives (0)
+{
+  NS_ASSERT (falsePositiveRate > 0 && falsePositiveRate < 1);
+  uint32_t words = std::max<uint32_t> (1, memory / (2 * sizeof (uint64_t)));
+  m_bitCount = words * 64;
+  // Optimal sizing of a Bloom filter: k = -log2 (p), n = -m ln2^2 / ln p
+  m_hashCount = std::max<uint32_t> (1, uint32_t (std::lround (-std::log2 (falsePositiveRate))));
+  m_capacity = std::max<uint32_t> (1, uint32_t (-(m_bitCount * std::log (2.0) * std::log (2.0))
+                                                / std::log (falsePositiveRate)));
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      m_filter[i].m_bits.assign (words, 0);
+      m_filter[i].m_set = 0;
+      m_filter[i].m_keys = 0;
+    }
+}
+
+void
+RotatingBloomFilter::Rotate ()
+{
+  m_current ^= 1;
+  Filter & f = m_filter[m_current];
+  std::fill (f.m_bits.begin (), f.m_bits.end (), 0);
+  f.m_set = 0;
+  f.m_keys = 0;
+  m_rotated = Simulator::Now ();
+}
+
+double
+RotatingBloomFilter::FalsePositiveProbability (Filter const & f) const
+{
+  return std::pow (double (f.m_set) / m_bitCount, double (m_hashCount));
+}
+
+bool
+RotatingBloomFilter::IsDuplicate (uint64_t key)
+{
+  Time now = Simulator::Now ();
+  if (now - m_rotated >= m_lifetime)
+    {
+      Time last = m_rotated;
+      Rotate ();
+      if (now - last >= 2 * m_lifetime)
+        {
+          // Idle for two lifetimes, forget everything
+          Rotate ();
+        }
+    }
+  m_lookups++;
+
+  uint64_t h1 = Mix64 (key);
+  uint64_t h2 = Mix64 (key ^ 0x9e3779b97f4a7c15ULL) | 1;
+  Filter & cur = m_filter[m_current];
+  Filter const & prev = m_filter[m_current ^ 1];
+  bool inCur = true;
+  bool inPrev = true;
+  for (uint32_t i = 0; i < m_hashCount; i++)
+    {
+      uint32_t bit = (h1 + i * h2) % m_bitCount;
+      uint64_t mask = uint64_t (1) << (bit % 64);
+      inCur = inCur && (cur.m_bits[bit / 64] & mask);
+      inPrev = inPrev && (prev.m_bits[bit / 64] & mask);
+    }
+  if (inCur || inPrev)
+    {
+      m_positives++;
+      return true;
+    }
+
+  double p = 1 - (1 - FalsePositiveProbability (cur)) * (1 - FalsePositiveProbability (prev));
+  m_estimatedFalsePositives += p / (1 - p);
+
+  if (cur.m_keys >= m_capacity)
+    {
+      m_earlyRotations++;
+      Rotate ();
+    }
+  Filter & f = m_filter[m_current];
+  for (uint32_t i = 0; i < m_hashCount; i++)
+    {
+      uint32_t bit = (h1 + i * h2) % m_bitCount;
+      uint64_t mask = uint64_t (1) << (bit % 64);
+      if (!(f.m_bits[bit / 64] & mask))
+        {
+          f.m_bits[bit / 64] |= mask;
+          f.m_set++;
+        }
+    }
+  f.m_keys++;
+  return false;
+}
+
+void
+DuplicatePacketDetection::SetMemoryBudget (uint32_t memory, double falsePositiveRate)
+{
+  m_filter.reset ();
+  if (memory > 0)
+    {
+      m_filter.reset (new RotatingBloomFilter (memory, falsePositiveRate, m_idCache.GetLifeTime ()));
+    }
+}
+
 bool
 DuplicatePacketDetection::IsDuplicate  (Ptr<const Packet> p, const Ipv4Header & header)
 {
-  return m_idCache.IsDuplicate (header.GetSource (), p->GetUid () );
+  if (m_filter != nullptr)
+    {
+      return m_filter->IsDuplicate ((uint64_t (header.GetSource ().Get ()) << 32) ^ p->GetUid ());
+    }
+  m_lookups++;
+  if (m_idCache.IsDuplicate (header.GetSource (), p->GetUid () ))
+    {
+      m_positives++;
+      return true;
+    }
+  return false;
+}
+
+uint64_t
+DuplicatePacketDetection::GetLookups () const
+{
+  return (m_filter != nullptr) ? m_filter->GetLookups () : m_lookups;
+}
+
+uint64_t
+DuplicatePacketDetection::GetPositives () const
+{
+  return (m_filter != nullptr) ? m_filter->GetPositives () : m_positives;
+}
+
+uint64_t
+DuplicatePacketDetection::GetEarlyRotations () const
+{
+  return (m_filter != nullptr) ? m_filter->GetEarlyRotations () : 0;
+}
+
+double
+DuplicatePacketDetection::GetEstimatedFalsePositives () const
+{
+  return (m_filter != nullptr) ? m_filter->GetEstimatedFalsePositives () : 0;
 }
 void
 DuplicatePacketDetection::SetLifetime (Time lifetime)
 {
   m_idCache.SetLifetime (lifetime);
+  if (m_filter != nullptr)
+    {
+      m_filter->SetLifetime (lifetime);
+    }
 }
 
 Time
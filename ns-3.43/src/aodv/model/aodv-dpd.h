@@ -27,9 +27,88 @@
 #include "ns3/nstime.h"
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
+#include <memory>
+#include <vector>
 
 namespace ns3 {
 namespace aodv {
+/**
+ * \ingroup aodv
+ *
+ * \brief Pair of Bloom filters rotated every lifetime, with a fixed memory size.
+ *
+ * Keys are inserted into the current filter and looked up in both. When the current
+ * filter is older than the lifetime it becomes the previous one and a cleared filter
+ * takes its place, so a key is remembered for at least one lifetime. If more keys
+ * arrive in one lifetime than the filter is sized for, it is rotated early to keep
+ * the false positive rate at its target, at the price of forgetting keys sooner.
+ */
+class RotatingBloomFilter
+{
+public:
+  /**
+   * Constructor
+   * \param memory total size of both filters, bytes
+   * \param falsePositiveRate target false positive rate of one lookup
+   * \param lifetime minimum time a key is remembered
+   */
+  RotatingBloomFilter (uint32_t memory, double falsePositiveRate, Time lifetime);
+  /**
+   * Check that key exists in a filter. Add it, if it doesn't exist.
+   * \param key the key
+   * \returns true if the key is (probably) in a filter
+   */
+  bool IsDuplicate (uint64_t key);
+  /// Set the minimum time a key is remembered
+  void SetLifetime (Time lifetime) { m_lifetime = lifetime; }
+  /// \returns number of keys one filter holds at the target false positive rate
+  uint32_t GetCapacity () const { return m_capacity; }
+  /// \returns number of lookups
+  uint64_t GetLookups () const { return m_lookups; }
+  /// \returns number of lookups answered as duplicate
+  uint64_t GetPositives () const { return m_positives; }
+  /// \returns number of rotations forced by a full filter before the lifetime elapsed
+  uint64_t GetEarlyRotations () const { return m_earlyRotations; }
+  /**
+   * Expected number of new keys wrongly reported as duplicate. Every key reported as
+   * new adds p / (1 - p), p being the filter false positive probability at that time,
+   * which is the expected number of false positives per true negative.
+   * \returns the estimate
+   */
+  double GetEstimatedFalsePositives () const { return m_estimatedFalsePositives; }
+
+private:
+  /// One filter
+  struct Filter
+  {
+    /// Bit array
+    std::vector<uint64_t> m_bits;
+    /// Number of bits set
+    uint32_t m_set;
+    /// Number of keys inserted
+    uint32_t m_keys;
+  };
+  /// Move the current filter to the previous one and clear the current one
+  void Rotate ();
+  /**
+   * \param f the filter
+   * \returns probability that a key not in f is reported in f
+   */
+  double FalsePositiveProbability (Filter const & f) const;
+
+  Filter m_filter[2];          ///< Current and previous filters
+  uint32_t m_current;          ///< Index of the current filter
+  uint32_t m_bitCount;         ///< Bits per filter
+  uint32_t m_hashCount;        ///< Hash functions per key
+  uint32_t m_capacity;         ///< Keys per filter at the target rate
+  Time m_lifetime;             ///< Rotation period
+  Time m_rotated;              ///< Time of the last rotation
+  uint64_t m_lookups;          ///< Lookups counter
+  uint64_t m_positives;        ///< Duplicates counter
+  uint64_t m_earlyRotations;   ///< Early rotations counter
+  double m_estimatedFalsePositives; ///< Expected false positives
+};
+
 /**
  * \ingroup aodv
  *
@@ -37,6 +116,10 @@ namespace aodv {
  *
  * Currently duplicate detection is based on unique packet ID given by Packet::GetUid ()
  * This approach is known to be weak (ns3::Packet UID is an internal identifier and not intended for logical uniqueness in models) and should be changed.
+ *
+ * By default packets are remembered exactly in an IdCache, whose size grows with the
+ * packet rate. SetMemoryBudget switches to a RotatingBloomFilter of bounded size that
+ * may wrongly report a new packet as duplicate.
  */
 class DuplicatePacketDetection
 {
@@ -45,9 +128,25 @@ public:
    * Constructor
    * \param lifetime the lifetime for added entries
    */
-  DuplicatePacketDetection (Time lifetime) : m_idCache (lifetime)
+  DuplicatePacketDetection (Time lifetime) : m_idCache (lifetime), m_lookups (0), m_positives (0)
   {
   }
+  /**
+   * Use a rotating Bloom filter of the given size instead of the exact cache.
+   * \param memory memory budget in bytes, 0 to go back to the exact cache
+   * \param falsePositiveRate target false positive rate
+   */
+  void SetMemoryBudget (uint32_t memory, double falsePositiveRate);
+  /// \returns the Bloom filter, or nullptr in exact mode
+  RotatingBloomFilter const * GetFilter () const { return m_filter.get (); }
+  /// \returns number of lookups
+  uint64_t GetLookups () const;
+  /// \returns number of lookups answered as duplicate
+  uint64_t GetPositives () const;
+  /// \returns number of early Bloom filter rotations, 0 in exact mode
+  uint64_t GetEarlyRotations () const;
+  /// \returns expected number of new packets reported as duplicate, 0 in exact mode
+  double GetEstimatedFalsePositives () const;
   /**
    * Check if the packet is a duplicate. If not, save information about this packet.
    * \param p the packet to check
@@ -66,8 +165,16 @@ public:
    */
   Time GetLifetime () const;
 private:
+  DuplicatePacketDetection (DuplicatePacketDetection const &);
+  DuplicatePacketDetection & operator= (DuplicatePacketDetection const &);
   /// Impl
   IdCache m_idCache;
+  /// Probabilistic impl, if any
+  std::unique_ptr<RotatingBloomFilter> m_filter;
+  /// Lookups counter of the exact cache
+  uint64_t m_lookups;
+  /// Duplicates counter of the exact cache
+  uint64_t m_positives;
 };
 
 }
@@ -34,33 +34,68 @@ bool
 IdCache::IsDuplicate (Ipv4Address addr, uint32_t id)
 {
   Purge ();
-  for (std::vector<UniqueId>::const_iterator i = m_idCache.begin ();
-       i != m_idCache.end (); ++i)
+  Time now = Simulator::Now ();
+  Time expire = m_lifetime + now;
+  UniqueId uniqueId = (uint64_t (addr.Get ()) << 32) | id;
+  std::pair<std::unordered_map<UniqueId, Time>::iterator, bool> result =
+    m_idCache.insert (std::make_pair (uniqueId, expire));
+  if (!result.second)
     {
-      if (i->m_context == addr && i->m_id == id)
+      if (result.first->second >= now)
         {
           return true;
         }
+      // Expired but its bucket is not purged yet
+      result.first->second = expire;
+    }
+  Time width = m_lifetime / BUCKETS;
+  if (m_buckets.empty () || expire > m_buckets.back ().m_first + width)
+    {
+      m_buckets.push_back (Bucket ());
+      m_buckets.back ().m_first = expire;
+      m_buckets.back ().m_last = expire;
     }
-  struct UniqueId uniqueId =
-  {
-    addr, id, m_lifetime + Simulator::Now ()
-  };
-  m_idCache.push_back (uniqueId);
+  else if (expire > m_buckets.back ().m_last)
+    {
+      m_buckets.back ().m_last = expire;
+    }
+  m_buckets.back ().m_ids.push_back (uniqueId);
   return false;
 }
 void
 IdCache::Purge ()
 {
-  m_idCache.erase (remove_if (m_idCache.begin (), m_idCache.end (),
-                              IsExpired ()), m_idCache.end ());
+  Time now = Simulator::Now ();
+  while (!m_buckets.empty () && m_buckets.front ().m_last < now)
+    {
+      std::vector<UniqueId> const & ids = m_buckets.front ().m_ids;
+      for (std::vector<UniqueId>::const_iterator i = ids.begin (); i != ids.end (); ++i)
+        {
+          std::unordered_map<UniqueId, Time>::iterator j = m_idCache.find (*i);
+          if (j != m_idCache.end () && j->second < now)
+            {
+              m_idCache.erase (j);
+            }
+        }
+      m_buckets.pop_front ();
+    }
 }
 
 uint32_t
 IdCache::GetSize ()
 {
   Purge ();
-  return m_idCache.size ();
+  Time now = Simulator::Now ();
+  uint32_t n = 0;
+  for (std::unordered_map<UniqueId, Time>::const_iterator i = m_idCache.begin ();
+       i != m_idCache.end (); ++i)
+    {
+      if (i->second >= now)
+        {
+          n++;
+        }
+    }
+  return n;
 }
 
 }
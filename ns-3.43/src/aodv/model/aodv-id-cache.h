@@ -31,6 +31,8 @@
 
 #include "ns3/ipv4-address.h"
 #include "ns3/simulator.h"
+#include <deque>
+#include <unordered_map>
 #include <vector>
 
 namespace ns3 {
@@ -39,6 +41,10 @@ namespace aodv {
  * \ingroup aodv
  *
  * \brief Unique packets identification cache used for simple duplicate detection.
+ *
+ * IDs are hashed by (address, id). Their expiry times are grouped into a ring of
+ * time buckets, each about lifetime / BUCKETS wide, so Purge only visits buckets
+ * whose entries have all expired.
  */
 class IdCache
 {
@@ -50,6 +56,8 @@ public:
   IdCache (Time lifetime) : m_lifetime (lifetime)
   {
   }
+  /// Number of time buckets per lifetime
+  static const uint32_t BUCKETS = 8;
   /**
    * Check that entry (addr, id) exists in cache. Add entry, if it doesn't exist.
    * \param addr the IP address
@@ -60,7 +68,7 @@ public:
   /// Remove all expired entries
   void Purge ();
   /**
-   * \returns number of entries in cache
+   * \returns number of unexpired entries in cache
    */
   uint32_t GetSize ();
   /**
@@ -80,34 +88,25 @@ public:
     return m_lifetime;
   }
 private:
-  /// Unique packet ID
-  struct UniqueId
-  {
-    /// ID is supposed to be unique in single address context (e.g. sender address)
-    Ipv4Address m_context;
-    /// The id
-    uint32_t m_id;
-    /// When record will expire
-    Time m_expire;
-  };
   /**
-   * \brief IsExpired structure
+   * Unique packet ID: the address in the high 32 bits, the id in the low ones.
+   * ID is supposed to be unique in single address context (e.g. sender address)
    */
-  struct IsExpired
+  typedef uint64_t UniqueId;
+  /// IDs whose expiry time falls in [m_first, m_last]
+  struct Bucket
   {
-    /**
-     * \brief Check if the entry is expired
-     *
-     * \param u UniqueId entry
-     * \return true if expired, false otherwise
-     */
-    bool operator() (const struct UniqueId & u) const
-    {
-      return (u.m_expire < Simulator::Now ());
-    }
+    /// Earliest expiry time in the bucket
+    Time m_first;
+    /// Latest expiry time in the bucket
+    Time m_last;
+    /// IDs added to the bucket; some may have been refreshed into a later one
+    std::vector<UniqueId> m_ids;
   };
-  /// Already seen IDs
-  std::vector<UniqueId> m_idCache;
+  /// Already seen IDs and their expiry times
+  std::unordered_map<UniqueId, Time> m_idCache;
+  /// Expiry buckets, oldest first
+  std::deque<Bucket> m_buckets;
   /// Default lifetime for ID records
   Time m_lifetime;
 };
@@ -5,10 +5,12 @@
  */
  
 #include "aodv-neighbor-etx.h"
+#include "aodv-neighbor-store.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include <math.h>
 #include <stdint.h>
+#include <algorithm>
 
 namespace ns3
 {
@@ -18,7 +20,21 @@ NS_LOG_COMPONENT_DEFINE ("AodvNeighborEtx");
 namespace aodv
 {
 
-NeighborEtx::NeighborEtx () : m_lppTimeStamp (0) {}
+NeighborEtx::NeighborEtx () : m_store (new NeighborStore), m_ownStore (true), m_lppTimeStamp (0), m_neighborCount (0),
+  m_passiveEnabled (false), m_passiveWeight (0.5), m_passiveAlpha (0.1), m_passiveMinSamples (10), m_passiveTimeout (Seconds (10)),
+  m_ettEnabled (false), m_ettDefaultRate (1000000), m_deadReckoning (false) {}
+
+NeighborEtx::NeighborEtx (NeighborStore & store) : m_store (&store), m_ownStore (false), m_lppTimeStamp (0), m_neighborCount (0),
+  m_passiveEnabled (false), m_passiveWeight (0.5), m_passiveAlpha (0.1), m_passiveMinSamples (10), m_passiveTimeout (Seconds (10)),
+  m_ettEnabled (false), m_ettDefaultRate (1000000), m_deadReckoning (false) {}
+
+NeighborEtx::~NeighborEtx ()
+{
+  if (m_ownStore)
+    {
+      delete m_store;
+    }
+}
 
 uint8_t
 NeighborEtx::CalculateNextLppTimeStamp (uint8_t currTimeStamp)
@@ -38,7 +54,7 @@ NeighborEtx::GotoNextLppTimeStamp ()
 }
 
 uint8_t 
-NeighborEtx::Lpp10bMapToCnt (uint16_t lpp10bMap)
+NeighborEtx::Lpp10bMapToCnt (uint16_t lpp10bMap) const
 {
   uint8_t lpp = 0;
   for (int j=0; j<12; ++j)
@@ -55,81 +71,325 @@ void
 NeighborEtx::GotoNextTimeStampAndClearOldest ()
 {
   GotoNextLppTimeStamp (); 
-  for (std::map<Ipv4Address, Etx>::iterator i = m_neighborEtx.begin (); i != m_neighborEtx.end (); ++i)
+  m_neighborCount = 0;
+  NeighborStore::Records & records = m_store->GetRecords ();
+  for (NeighborStore::Records::iterator i = records.begin (); i != records.end (); ++i)
     {
-      Etx etx = i->second;
-      uint16_t lppMyCnt10bMap = etx.m_lppMyCnt10bMap;
-      lppMyCnt10bMap &= (uint16_t)(~((uint16_t)0x0001 << CalculateNextLppTimeStamp (m_lppTimeStamp)) & (uint16_t)0x0FFF);
-      etx.m_lppMyCnt10bMap = lppMyCnt10bMap;
-      i->second = etx;
+      if (!i->second.m_hasEtx)
+        {
+          continue;
+        }
+      bool heard = false;
+      std::vector<Link> & links = i->second.m_etx.m_links;
+      for (std::vector<Link>::iterator l = links.begin (); l != links.end (); ++l)
+        {
+          uint16_t lppMyCnt10bMap = l->m_lppMyCnt10bMap;
+          lppMyCnt10bMap &= (uint16_t)(~((uint16_t)0x0001 << CalculateNextLppTimeStamp (m_lppTimeStamp)) & (uint16_t)0x0FFF);
+          l->m_lppMyCnt10bMap = lppMyCnt10bMap;
+          heard = heard || lppMyCnt10bMap != 0;
+        }
+      if (heard)
+        {
+          m_neighborCount++;
+        }
+      // Jendela LPP bergeser: metrik yang disimpan sudah basi
+      i->second.m_metricTime = Seconds (-1);
     }  
 }
 
 void
-NeighborEtx::FillLppCntData (LppHeader &lppHeader)
+NeighborEtx::FillLppCntData (LppHeader &lppHeader, uint32_t iface)
 {
-  for (std::map<Ipv4Address, Etx>::iterator i = m_neighborEtx.begin (); i != m_neighborEtx.end (); ++i)
+  NeighborStore::Records const & records = m_store->GetRecords ();
+  for (NeighborStore::Records::const_iterator i = records.begin (); i != records.end (); ++i)
         {
-          uint8_t lpp = Lpp10bMapToCnt (i->second.m_lppMyCnt10bMap);
-          if (lpp > 0)
+          if (!i->second.m_hasEtx)
             {
-              lppHeader.AddToNeighborsList (i->first, lpp);
+              continue;
             }
+          std::vector<Link> const & links = i->second.m_etx.m_links;
+          for (std::vector<Link>::const_iterator l = links.begin (); l != links.end (); ++l)
+            {
+              if (l->m_interface != iface)
+                {
+                  continue;
+                }
+              uint8_t lpp = Lpp10bMapToCnt (l->m_lppMyCnt10bMap);
+              if (lpp > 0)
+                {
+                  lppHeader.AddToNeighborsList (i->first, lpp);
+                }
+              break;
+            }
+        }
+}
+
+NeighborEtx::Link &
+NeighborEtx::GetLink (Etx & etx, uint32_t iface)
+{
+  for (std::vector<Link>::iterator l = etx.m_links.begin (); l != etx.m_links.end (); ++l)
+    {
+      if (l->m_interface == iface)
+        {
+          return *l;
         }
+    }
+  etx.m_links.push_back (Link (iface));
+  return etx.m_links.back ();
 }
 
 // --- IMPLEMENTASI BARU: UPDATE DENGAN POSISI & KECEPATAN ---
 bool 
-NeighborEtx::UpdateNeighborEtx (Ipv4Address addr, uint8_t lppTimeStamp, uint8_t lppReverse, Vector neighborPos, Vector neighborVel)
+NeighborEtx::UpdateNeighborEtx (Ipv4Address addr, uint32_t iface, uint8_t lppTimeStamp, uint8_t lppReverse, Vector neighborPos, Vector neighborVel)
+{
+  return UpdateNeighborEtx (m_store->Get (addr), iface, lppTimeStamp, lppReverse, neighborPos, neighborVel);
+}
+
+bool 
+NeighborEtx::UpdateNeighborEtx (NeighborRecord & nb, uint32_t iface, uint8_t lppTimeStamp, uint8_t lppReverse, Vector neighborPos, Vector neighborVel)
 {
-  std::map<Ipv4Address, Etx>::iterator i = m_neighborEtx.find (addr);
-  if (i == m_neighborEtx.end ())
+  nb.m_metricTime = Seconds (-1);
+  if (!nb.m_hasEtx)
     {
-      Etx etx;
-      etx.m_lppReverse = lppReverse;
-      etx.m_lppMyCnt10bMap = (uint16_t)0x0001 << lppTimeStamp;
-      
-      // Simpan data mobilitas tetangga
-      etx.m_position = neighborPos;
-      etx.m_velocity = neighborVel;
-      
-      m_neighborEtx.insert (std::make_pair (addr, etx));
-      return true;
+      nb.m_etx = Etx ();
+      nb.m_hasEtx = true;
     }
-  else
+  bool heard = false;
+  for (std::vector<Link>::const_iterator l = nb.m_etx.m_links.begin (); l != nb.m_etx.m_links.end (); ++l)
     {
-      i->second.m_lppReverse = lppReverse;
-      (i->second.m_lppMyCnt10bMap) |= ((uint16_t)0x0001 << lppTimeStamp);
-      
-      // Update data mobilitas tetangga
-      i->second.m_position = neighborPos;
-      i->second.m_velocity = neighborVel;
-      return true;
+      heard = heard || l->m_lppMyCnt10bMap != 0;
+    }
+  if (!heard)
+    {
+      m_neighborCount++;
     }
+
+  // Bitmap LPP per interface: tetangga yang terdengar di dua radio punya dua link
+  Link & link = GetLink (nb.m_etx, iface);
+  link.m_lppReverse = lppReverse;
+  link.m_lppMyCnt10bMap |= ((uint16_t)0x0001 << lppTimeStamp);
+      
+  // Update data mobilitas tetangga
+  nb.m_etx.m_position = neighborPos;
+  nb.m_etx.m_velocity = neighborVel;
+  nb.m_etx.m_positionTime = Simulator::Now ();
+  return true;
 }
 
 uint32_t 
-NeighborEtx::CalculateBinaryShiftedEtx (Etx etxStruct)
+NeighborEtx::CalculateBinaryShiftedEtx (Link const & link) const
 {
   uint32_t etx = UINT32_MAX;
-  if ((Lpp10bMapToCnt (etxStruct.m_lppMyCnt10bMap)!=0) && (etxStruct.m_lppReverse!=0))
+  if ((Lpp10bMapToCnt (link.m_lppMyCnt10bMap)!=0) && (link.m_lppReverse!=0))
+    {
+      etx = (uint32_t) (round (1000000.0 / (Lpp10bMapToCnt (link.m_lppMyCnt10bMap) * link.m_lppReverse)));
+    }
+
+  // ETX pasif hanya dipakai jika cukup sampel dan masih segar
+  if (!m_passiveEnabled || link.m_macSamples < m_passiveMinSamples
+      || Simulator::Now () - link.m_macLast > m_passiveTimeout)
+    {
+      return etx;
+    }
+  // Rasio sukses per percobaan sudah termasuk ACK, jadi ETX = 1 / rasio (dibatasi 100)
+  double passive = 10000.0 / std::max (link.m_macDelivery, 0.01);
+  if (etx == UINT32_MAX)
+    {
+      // LPP jarang: tetangga tetap terukur dari lalu lintas data
+      return (uint32_t) round (passive);
+    }
+  return (uint32_t) round (m_passiveWeight * passive + (1 - m_passiveWeight) * etx);
+}
+
+void
+NeighborEtx::SetEtt (bool enable, uint64_t defaultRate)
+{
+  m_ettEnabled = enable;
+  m_ettDefaultRate = defaultRate;
+}
+
+void
+NeighborEtx::RecvPairProbe (Ipv4Address addr, uint32_t iface, uint32_t id, bool second, uint32_t size)
+{
+  NeighborRecord * nb = m_store->Find (addr);
+  if (nb == 0 || !nb->m_hasEtx)
+    {
+      return;
+    }
+  Link & link = GetLink (nb->m_etx, iface);
+  if (!second)
+    {
+      link.m_pairId = id;
+      link.m_pairFirst = Simulator::Now ();
+      return;
+    }
+  // Paket kedua tanpa paket pertama (hilang atau tertukar): buang
+  if (link.m_pairFirst.IsStrictlyNegative () || link.m_pairId != id)
+    {
+      return;
+    }
+  Time dispersion = Simulator::Now () - link.m_pairFirst;
+  link.m_pairFirst = Seconds (-1);
+  if (!dispersion.IsStrictlyPositive ())
+    {
+      return;
+    }
+  link.m_pairBandwidth[link.m_pairNext] = size * 8.0 / dispersion.GetSeconds ();
+  link.m_pairNext = (link.m_pairNext + 1) % 4;
+  nb->m_metricTime = Seconds (-1);
+}
+
+uint32_t
+NeighborEtx::CalculateLinkMetric (Link const & link) const
+{
+  uint32_t etx = CalculateBinaryShiftedEtx (link);
+  if (!m_ettEnabled || etx == UINT32_MAX)
+    {
+      return etx;
+    }
+  // Dispersi terkecil (bandwidth terbesar) di jendela: antrean hanya bisa menambah dispersi
+  double bandwidth = 0;
+  for (uint8_t k = 0; k < 4; ++k)
+    {
+      bandwidth = std::max (bandwidth, link.m_pairBandwidth[k]);
+    }
+  if (bandwidth <= 0)
+    {
+      bandwidth = m_ettDefaultRate;
+    }
+  // ETT = ETX * S / B, dinormalisasi ke S / defaultRate: link sempurna di defaultRate = 10000
+  // seperti ETX 1.0, jadi parameter dalam satuan ETX (histeresis, beban, delay) tetap berlaku
+  double ett = etx * (double) m_ettDefaultRate / bandwidth;
+  return (uint32_t) std::min (round (ett), (double)(UINT32_MAX - 1));
+}
+
+int32_t
+NeighborEtx::BestLinkIndex (Etx const & etx, uint32_t & etxOut) const
+{
+  int32_t best = -1;
+  etxOut = UINT32_MAX;
+  for (uint32_t i = 0; i < etx.m_links.size (); ++i)
+    {
+      uint32_t e = CalculateLinkMetric (etx.m_links[i]);
+      if (best < 0 || e < etxOut)
+        {
+          best = i;
+          etxOut = e;
+        }
+    }
+  return best;
+}
+
+uint32_t
+NeighborEtx::GetEtx (Etx const & etx) const
+{
+  uint32_t e;
+  int32_t best = BestLinkIndex (etx, e);
+  return best < 0 ? UINT32_MAX : CalculateBinaryShiftedEtx (etx.m_links[best]);
+}
+
+NeighborEtx::Link const *
+NeighborEtx::GetBestLink (Etx const & etx) const
+{
+  uint32_t e;
+  int32_t best = BestLinkIndex (etx, e);
+  return best < 0 ? 0 : &etx.m_links[best];
+}
+
+void
+NeighborEtx::UpdateNeighborLoad (NeighborRecord & nb, uint16_t load)
+{
+  if (nb.m_hasEtx)
+    {
+      nb.m_etx.m_load = load;
+    }
+}
+
+uint16_t
+NeighborEtx::GetNeighborLoad (Ipv4Address addr)
+{
+  NeighborRecord * nb = m_store->Find (addr);
+  if (nb == 0 || !nb->m_hasEtx)
+    {
+      return 0;
+    }
+  return nb->m_etx.m_load;
+}
+
+int32_t
+NeighborEtx::GetBestInterface (Ipv4Address addr)
+{
+  NeighborRecord * nb = m_store->Find (addr);
+  if (nb == 0 || !nb->m_hasEtx)
+    {
+      return -1;
+    }
+  uint32_t e;
+  int32_t best = BestLinkIndex (nb->m_etx, e);
+  return best < 0 ? -1 : int32_t (nb->m_etx.m_links[best].m_interface);
+}
+
+void
+NeighborEtx::SetPassiveEtx (bool enable, double weight, double alpha, uint32_t minSamples, Time timeout)
+{
+  m_passiveEnabled = enable;
+  m_passiveWeight = weight;
+  m_passiveAlpha = alpha;
+  m_passiveMinSamples = minSamples;
+  m_passiveTimeout = timeout;
+}
+
+void
+NeighborEtx::ReportTxOutcome (Ipv4Address addr, uint32_t iface, bool ok)
+{
+  if (!m_passiveEnabled)
+    {
+      return;
+    }
+  NeighborRecord * nb = m_store->Find (addr);
+  if (nb == 0 || !nb->m_hasEtx)
+    {
+      return;
+    }
+  // Hanya link yang sudah dikenal dari LPP di interface pengirim
+  std::vector<Link>::iterator l = nb->m_etx.m_links.begin ();
+  while (l != nb->m_etx.m_links.end () && l->m_interface != iface)
+    {
+      ++l;
+    }
+  if (l == nb->m_etx.m_links.end ())
+    {
+      return;
+    }
+  Link & etx = *l;
+  // Estimasi lama sudah basi: mulai lagi dari nol
+  if (Simulator::Now () - etx.m_macLast > m_passiveTimeout)
+    {
+      etx.m_macDelivery = 1.0;
+      etx.m_macSamples = 0;
+    }
+  // Rata-rata biasa selama sampel masih sedikit, lalu EWMA
+  double alpha = std::max (m_passiveAlpha, 1.0 / (etx.m_macSamples + 1));
+  etx.m_macDelivery = (1 - alpha) * etx.m_macDelivery + alpha * (ok ? 1.0 : 0.0);
+  if (etx.m_macSamples < UINT16_MAX)
     {
-      etx = (uint32_t) (round (1000000.0 / (Lpp10bMapToCnt (etxStruct.m_lppMyCnt10bMap) * etxStruct.m_lppReverse)));
+      etx.m_macSamples++;
     }
-  return etx;
+  etx.m_macLast = Simulator::Now ();
+  nb->m_metricTime = Seconds (-1);
 }
 
 uint32_t 
 NeighborEtx::GetEtxForNeighbor (Ipv4Address addr)
 {
-  std::map<Ipv4Address, Etx>::iterator i = m_neighborEtx.find (addr);
-  if (i == m_neighborEtx.end ())
+  NeighborRecord * nb = m_store->Find (addr);
+  if (nb == 0 || !nb->m_hasEtx)
     {
       return UINT32_MAX;
     }
   else
     {
-      return CalculateBinaryShiftedEtx (i->second);
+      return GetEtx (nb->m_etx);
     }
 }
 
@@ -160,25 +420,65 @@ NeighborEtx::CalculateLet (Vector myPos, Vector myVel, Vector neighPos, Vector n
 uint32_t 
 NeighborEtx::GetHybridMetric (Ipv4Address addr, Vector myPos, Vector myVel)
 {
-  std::map<Ipv4Address, Etx>::iterator i = m_neighborEtx.find (addr);
-  if (i == m_neighborEtx.end ()) return UINT32_MAX;
+  NeighborRecord * nb = m_store->Find (addr);
+  if (nb == 0) return UINT32_MAX;
+  return GetHybridMetric (*nb, myPos, myVel);
+}
+
+uint32_t 
+NeighborEtx::GetHybridMetric (NeighborRecord & nb, Vector myPos, Vector myVel)
+{
+  if (!nb.m_hasEtx) return UINT32_MAX;
 
-  // 1. Hitung ETX
-  uint32_t baseEtx = CalculateBinaryShiftedEtx (i->second);
+  // Posisi node tetap dalam satu waktu simulasi: pakai metrik yang disimpan
+  if (nb.m_metricTime == Simulator::Now ())
+    {
+      return nb.m_metric;
+    }
+  nb.m_metricTime = Simulator::Now ();
 
-  // 2. Hitung LET
-  double let = CalculateLet (myPos, myVel, i->second.m_position, i->second.m_velocity);
+  // 1. Hitung ETX, atau ETT (link terbaik di antara semua interface)
+  uint32_t baseEtx;
+  BestLinkIndex (nb.m_etx, baseEtx);
+
+  // 2. Hitung LET dari posisi tetangga sekarang
+  double let = CalculateLet (myPos, myVel, GetNeighborPosition (nb.m_etx), nb.m_etx.m_velocity);
 
   // NS_LOG_UNCOND ("IP: " << addr << " ETX: " << baseEtx << " LET: " << let);
 
   // 3. Logika Threshold: Jika LET < 1 detik, anggap link putus (Max Metric)
   if (let < 1.0) 
     {
+      nb.m_metric = UINT32_MAX;
       return UINT32_MAX; 
     }
   
+  nb.m_metric = baseEtx;
   return baseEtx;
 }
 
+Time
+NeighborEtx::GetLinkExpirationTime (Ipv4Address addr, Vector myPos, Vector myVel)
+{
+  NeighborRecord * nb = m_store->Find (addr);
+  if (nb == 0 || !nb->m_hasEtx) return Seconds (0);
+
+  return Seconds (CalculateLet (myPos, myVel, GetNeighborPosition (nb->m_etx), nb->m_etx.m_velocity));
+}
+
+Vector
+NeighborEtx::GetNeighborPosition (Etx const & etx) const
+{
+  if (!m_deadReckoning)
+    {
+      return etx.m_position;
+    }
+  // Anggap kecepatan tetap sejak LPP/RREQ/RREP terakhir
+  double age = (Simulator::Now () - etx.m_positionTime).GetSeconds ();
+  return Vector (etx.m_position.x + etx.m_velocity.x * age,
+                 etx.m_position.y + etx.m_velocity.y * age,
+                 etx.m_position.z + etx.m_velocity.z * age);
+}
+
 } // namespace aodv
 } // namespace ns3
\ No newline at end of file
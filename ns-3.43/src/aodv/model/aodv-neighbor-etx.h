@@ -20,8 +20,10 @@
 #define AODVNEIGHBORETX_H
 
 #include <map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 #include "ns3/aodv-packet.h"
+#include "ns3/nstime.h"
 #include "ns3/vector.h" // <--- WAJIB: Untuk menyimpan posisi/kecepatan
 
 namespace ns3
@@ -29,48 +31,145 @@ namespace ns3
 namespace aodv
 {
 
+class NeighborStore;
+struct NeighborRecord;
+
 class NeighborEtx
 {
 public:
   NeighborEtx ();
+  // Simpan data ETX di record NeighborStore bersama
+  NeighborEtx (NeighborStore & store);
+  ~NeighborEtx ();
   
-  struct Etx
+  // Kualitas link ke tetangga lewat satu interface lokal (node multi-radio punya beberapa)
+  struct Link
   {
+    uint32_t m_interface;   // indeks interface IP lokal
     uint16_t m_lppMyCnt10bMap;
     uint8_t m_lppReverse;
+
+    // --- ETX PASIF DARI FRAME DATA UNICAST (MAC) ---
+    double m_macDelivery;   // rasio sukses EWMA per percobaan kirim
+    uint16_t m_macSamples;  // jumlah percobaan yang sudah tercatat (jenuh)
+    Time m_macLast;         // waktu percobaan terakhir
+
+    // --- ETT: bandwidth dari dispersi packet-pair (bit/s), jendela sampel terakhir ---
+    double m_pairBandwidth[4];
+    uint8_t m_pairNext;     // slot sampel berikutnya
+    uint32_t m_pairId;      // id pasangan yang paket pertamanya sudah diterima
+    Time m_pairFirst;       // waktu terima paket pertama, negatif jika tidak ada
+
+    Link (uint32_t iface) : m_interface (iface), m_lppMyCnt10bMap (0), m_lppReverse (0),
+                            m_macDelivery (1.0), m_macSamples (0), m_macLast (Seconds (0)),
+                            m_pairNext (0), m_pairId (0), m_pairFirst (Seconds (-1))
+    {
+      for (uint8_t k = 0; k < 4; ++k)
+        {
+          m_pairBandwidth[k] = 0;
+        }
+    }
+  };
+
+  struct Etx
+  {
+    // Satu entri per interface tempat LPP tetangga terdengar, biasanya hanya satu
+    std::vector<Link> m_links;
     
     // --- TAMBAHAN UNTUK LET ---
     Vector m_position; 
     Vector m_velocity; 
+    Time m_positionTime;    // waktu posisi/kecepatan di atas diterima
     // ---------------------------
 
-    Etx () : m_lppMyCnt10bMap (0), m_lppReverse (0), m_position(0,0,0), m_velocity(0,0,0) {}
+    uint16_t m_load;        // paket antre yang diumumkan tetangga di LPP terakhir
+
+    Etx () : m_position(0,0,0), m_velocity(0,0,0), m_positionTime (Seconds (0)), m_load (0) {}
   };
    
   uint8_t GetLppTimeStamp () {return m_lppTimeStamp; }
   void GotoNextTimeStampAndClearOldest ();
-  void FillLppCntData (LppHeader &lppHeader);
+  // Hanya tetangga yang terdengar di interface iface
+  void FillLppCntData (LppHeader &lppHeader, uint32_t iface);
   
-  // --- FUNGSI UPDATE BARU (Dengan Vector) ---
-  bool UpdateNeighborEtx (Ipv4Address addr, uint8_t lppTimeStamp, uint8_t lppReverse, Vector neighborPos, Vector neighborVel);
+  // --- FUNGSI UPDATE BARU (Dengan Vector), iface = interface tempat paket diterima ---
+  bool UpdateNeighborEtx (Ipv4Address addr, uint32_t iface, uint8_t lppTimeStamp, uint8_t lppReverse, Vector neighborPos, Vector neighborVel);
+  bool UpdateNeighborEtx (NeighborRecord & nb, uint32_t iface, uint8_t lppTimeStamp, uint8_t lppReverse, Vector neighborPos, Vector neighborVel);
   
   uint32_t GetEtxForNeighbor (Ipv4Address addr);
 
+  // --- ETX PASIF: hasil kirim frame data dari MAC, dicampur dengan ETX LPP ---
+  // weight = bobot ETX pasif, alpha = faktor EWMA, minSamples/timeout = kapan estimasi pasif dipakai
+  void SetPassiveEtx (bool enable, double weight, double alpha, uint32_t minSamples, Time timeout);
+  // iface = interface tempat frame dikirim
+  void ReportTxOutcome (Ipv4Address addr, uint32_t iface, bool ok);
+
+  // --- ETT = ETX * defaultRate / bandwidth sebagai pengganti ETX di metrik hybrid ---
+  // defaultRate = bandwidth (bit/s) selama belum ada sampel packet-pair, juga acuan normalisasi
+  void SetEtt (bool enable, uint64_t defaultRate);
+  // Paket probe packet-pair dari addr diterima di interface iface, size = byte paket
+  void RecvPairProbe (Ipv4Address addr, uint32_t iface, uint32_t id, bool second, uint32_t size);
+
+  // --- Dead reckoning: posisi tetangga sekarang = posisi terakhir + kecepatan * umur ---
+  void SetDeadReckoning (bool enable) { m_deadReckoning = enable; }
+  Vector GetNeighborPosition (Etx const & etx) const;
+
   // --- FUNGSI METRIK HYBRID (ETX + LET) ---
   uint32_t GetHybridMetric (Ipv4Address addr, Vector myPos, Vector myVel);
+  // Disimpan di record, dihitung ulang sekali per waktu simulasi
+  uint32_t GetHybridMetric (NeighborRecord & nb, Vector myPos, Vector myVel);
+
+  // --- Beban tetangga dari LPP (0 jika tidak dikenal) ---
+  void UpdateNeighborLoad (NeighborRecord & nb, uint16_t load);
+  uint16_t GetNeighborLoad (Ipv4Address addr);
+
+  // --- Interface lokal dengan ETX terbaik ke tetangga (-1 jika tidak dikenal) ---
+  int32_t GetBestInterface (Ipv4Address addr);
+
+  // --- LET link ke tetangga (0 jika tetangga tidak dikenal) ---
+  Time GetLinkExpirationTime (Ipv4Address addr, Vector myPos, Vector myVel);
 
   static uint32_t EtxMaxValue () { return UINT32_MAX; };
 
+  // --- Jumlah tetangga yang terdengar dalam jendela LPP (untuk supresi RREQ) ---
+  uint32_t GetNeighborCount () const { return m_neighborCount; }
+
+  // --- Akses baca untuk snapshot ---
+  NeighborStore const & GetStore () const { return *m_store; }
+  uint32_t GetEtx (Etx const & etx) const;
+  Link const * GetBestLink (Etx const & etx) const;
+
 private:
-  std::map<Ipv4Address, Etx> m_neighborEtx;
+  NeighborEtx (NeighborEtx const &);
+  NeighborEtx & operator= (NeighborEtx const &);
+
+  NeighborStore * m_store;
+  bool m_ownStore;
   uint8_t m_lppTimeStamp; 
+  uint32_t m_neighborCount;
+
+  bool m_passiveEnabled;
+  double m_passiveWeight;
+  double m_passiveAlpha;
+  uint32_t m_passiveMinSamples;
+  Time m_passiveTimeout;
+
+  bool m_ettEnabled;
+  uint64_t m_ettDefaultRate;
+
+  bool m_deadReckoning;
    
-  uint32_t CalculateBinaryShiftedEtx (struct Etx etxStruct);
+  uint32_t CalculateBinaryShiftedEtx (Link const & link) const;
+  // ETX link, atau ETT jika diaktifkan
+  uint32_t CalculateLinkMetric (Link const & link) const;
+  // Indeks link dengan metrik (ETX/ETT) terkecil di etx.m_links (-1 jika kosong), metriknya di etxOut
+  int32_t BestLinkIndex (Etx const & etx, uint32_t & etxOut) const;
+  static Link & GetLink (Etx & etx, uint32_t iface);
   
   // --- HITUNG LET ---
   double CalculateLet (Vector myPos, Vector myVel, Vector neighPos, Vector neighVel);
 
-  uint8_t Lpp10bMapToCnt (uint16_t lpp10bMap);
+  uint8_t Lpp10bMapToCnt (uint16_t lpp10bMap) const;
   void GotoNextLppTimeStamp ();
   static uint8_t CalculateNextLppTimeStamp (uint8_t currTimeStamp);
 };
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "aodv-neighbor-store.h"
+#include "aodv-rtable.h"
+
+namespace ns3 {
+namespace aodv {
+
+NeighborRecord::NeighborRecord (Ipv4Address addr)
+  : m_address (addr),
+    m_hasLink (false),
+    m_link (addr, Mac48Address (), Seconds (0)),
+    m_hasEtx (false),
+    m_metric (NeighborEtx::EtxMaxValue ()),
+    m_metricTime (Seconds (-1)),
+    m_route (0),
+    m_routeGeneration (0)
+{
+}
+
+NeighborRecord *
+NeighborStore::Find (Ipv4Address addr)
+{
+  Records::iterator i = m_records.find (addr);
+  return (i == m_records.end ()) ? 0 : &i->second;
+}
+
+NeighborRecord &
+NeighborStore::Get (Ipv4Address addr)
+{
+  Records::iterator i = m_records.find (addr);
+  if (i == m_records.end ())
+    {
+      i = m_records.insert (std::make_pair (addr, NeighborRecord (addr))).first;
+    }
+  return i->second;
+}
+
+void
+NeighborStore::Release (NeighborRecord & r)
+{
+  if (!r.m_hasLink && !r.m_hasEtx)
+    {
+      m_records.erase (r.m_address);
+    }
+}
+
+RoutingTableEntry *
+NeighborStore::GetRoute (NeighborRecord & r, RoutingTable & table)
+{
+  if (r.m_route == 0 || r.m_routeGeneration != table.GetGeneration ())
+    {
+      r.m_route = table.FindEntry (r.m_address);
+      r.m_routeGeneration = table.GetGeneration ();
+    }
+  return r.m_route;
+}
+
+}  // namespace aodv
+}  // namespace ns3
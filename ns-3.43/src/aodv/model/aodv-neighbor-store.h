@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AODVNEIGHBORSTORE_H
+#define AODVNEIGHBORSTORE_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "aodv-neighbor.h"
+#include "aodv-neighbor-etx.h"
+
+namespace ns3 {
+namespace aodv {
+
+class RoutingTable;
+class RoutingTableEntry;
+
+/**
+ * \ingroup aodv
+ * \brief Everything known about one neighbor
+ *
+ * Neighbors and NeighborEtx are views over these records: each one owns the
+ * fields behind its flag. A record lives as long as one of the flags is set.
+ */
+struct NeighborRecord
+{
+  /**
+   * constructor
+   * \param addr the neighbor address
+   */
+  NeighborRecord (Ipv4Address addr);
+
+  /// Neighbor address
+  Ipv4Address m_address;
+  /// The link is alive and m_link is used by Neighbors
+  bool m_hasLink;
+  /// Link liveness and MAC address
+  Neighbors::Neighbor m_link;
+  /// An LPP or a mobility report was received and m_etx is used by NeighborEtx
+  bool m_hasEtx;
+  /// LPP bitmaps and mobility
+  NeighborEtx::Etx m_etx;
+  /// Hybrid metric computed at m_metricTime
+  uint32_t m_metric;
+  /// Time m_metric was computed, negative once stale
+  Time m_metricTime;
+  /// Route to the neighbor, see NeighborStore::GetRoute
+  RoutingTableEntry * m_route;
+  /// Routing table generation m_route belongs to
+  uint32_t m_routeGeneration;
+};
+
+/**
+ * \ingroup aodv
+ * \brief Neighbor records shared by Neighbors and NeighborEtx, found with one hash lookup
+ */
+class NeighborStore
+{
+public:
+  /// Records by neighbor address
+  typedef std::unordered_map<Ipv4Address, NeighborRecord, Ipv4AddressHash> Records;
+
+  /**
+   * \param addr the neighbor address
+   * \returns the record of addr, or 0
+   */
+  NeighborRecord * Find (Ipv4Address addr);
+  /**
+   * \param addr the neighbor address
+   * \returns the record of addr, created if needed
+   */
+  NeighborRecord & Get (Ipv4Address addr);
+  /**
+   * Remove a record no view uses any more
+   * \param r the record, invalid after the call if removed
+   */
+  void Release (NeighborRecord & r);
+  /// \returns all records
+  Records & GetRecords () { return m_records; }
+  /// \returns all records
+  Records const & GetRecords () const { return m_records; }
+  /**
+   * Return the route to a neighbor, without purging or copying. The handle is
+   * kept in the record and looked up again only when a route was erased.
+   * \param r the neighbor record
+   * \param table the routing table
+   * \returns the primary entry for the neighbor address, any hop count, or 0
+   */
+  static RoutingTableEntry * GetRoute (NeighborRecord & r, RoutingTable & table);
+
+private:
+  /// The records
+  Records m_records;
+};
+
+}  // namespace aodv
+}  // namespace ns3
+
+#endif /* AODVNEIGHBORSTORE_H */
@@ -29,7 +29,9 @@
 #include <algorithm>
 #include "ns3/log.h"
 #include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-mpdu.h"
 #include "aodv-neighbor.h"
+#include "aodv-neighbor-store.h"
 
 namespace ns3 {
 
@@ -37,39 +39,55 @@ NS_LOG_COMPONENT_DEFINE ("AodvNeighbors");
 
 namespace aodv {
 Neighbors::Neighbors (Time delay)
-  : m_ntimer (Timer::CANCEL_ON_DESTROY)
+  : m_ntimer (Timer::CANCEL_ON_DESTROY),
+    m_store (new NeighborStore),
+    m_ownStore (true)
 {
   m_ntimer.SetDelay (delay);
-  m_ntimer.SetFunction (&Neighbors::Purge, this);
+  m_ntimer.SetFunction (&Neighbors::PurgeTimerExpire, this);
   m_txErrorCallback = MakeCallback (&Neighbors::ProcessTxError, this);
 }
 
+Neighbors::Neighbors (Time delay, NeighborStore & store)
+  : m_ntimer (Timer::CANCEL_ON_DESTROY),
+    m_store (&store),
+    m_ownStore (false)
+{
+  m_ntimer.SetDelay (delay);
+  m_ntimer.SetFunction (&Neighbors::PurgeTimerExpire, this);
+  m_txErrorCallback = MakeCallback (&Neighbors::ProcessTxError, this);
+}
+
+Neighbors::~Neighbors ()
+{
+  if (m_ownStore)
+    {
+      delete m_store;
+    }
+}
+
+Neighbors::Neighbor *
+Neighbors::Find (Ipv4Address addr)
+{
+  NeighborRecord * r = m_store->Find (addr);
+  return (r != 0 && r->m_hasLink) ? &r->m_link : 0;
+}
+
 bool
 Neighbors::IsNeighbor (Ipv4Address addr)
 {
   Purge ();
-  for (std::vector<Neighbor>::const_iterator i = m_nb.begin ();
-       i != m_nb.end (); ++i)
-    {
-      if (i->m_neighborAddress == addr)
-        {
-          return true;
-        }
-    }
-  return false;
+  return Find (addr) != 0;
 }
 
 Time
 Neighbors::GetExpireTime (Ipv4Address addr)
 {
   Purge ();
-  for (std::vector<Neighbor>::const_iterator i = m_nb.begin (); i
-       != m_nb.end (); ++i)
+  Neighbor const * nb = Find (addr);
+  if (nb != 0)
     {
-      if (i->m_neighborAddress == addr)
-        {
-          return (i->m_expireTime - Simulator::Now ());
-        }
+      return (nb->m_expireTime - Simulator::Now ());
     }
   return Seconds (0);
 }
@@ -77,24 +95,54 @@ Neighbors::GetExpireTime (Ipv4Address addr)
 void
 Neighbors::Update (Ipv4Address addr, Time expire)
 {
-  for (std::vector<Neighbor>::iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+  Update (m_store->Get (addr), expire);
+}
+
+void
+Neighbors::Update (NeighborRecord & r, Time expire)
+{
+  Ipv4Address addr = r.m_address;
+  if (r.m_hasLink)
     {
-      if (i->m_neighborAddress == addr)
+      Time t = expire + Simulator::Now ();
+      if (t > r.m_link.m_expireTime)
         {
-          i->m_expireTime
-            = std::max (expire + Simulator::Now (), i->m_expireTime);
-          if (i->m_hardwareAddress == Mac48Address ())
-            {
-              i->m_hardwareAddress = LookupMacAddress (i->m_neighborAddress);
-            }
-          return;
+          // The earliest expiry can only move later: the timer may fire early and re-arm itself
+          m_expiry.erase (std::make_pair (r.m_link.m_expireTime, addr));
+          m_expiry.insert (std::make_pair (t, addr));
+          r.m_link.m_expireTime = t;
         }
+      if (r.m_link.m_hardwareAddress == Mac48Address ())
+        {
+          ResolveMacAddress (r.m_link);
+        }
+      return;
     }
 
   NS_LOG_LOGIC ("Open link to " << addr);
-  Neighbor neighbor (addr, LookupMacAddress (addr), expire + Simulator::Now ());
-  m_nb.push_back (neighbor);
-  Purge ();
+  r.m_link = Neighbor (addr, LookupMacAddress (addr), expire + Simulator::Now ());
+  r.m_hasLink = true;
+  if (r.m_link.m_hardwareAddress != Mac48Address ())
+    {
+      m_macIndex.insert (std::make_pair (MacKey (r.m_link.m_hardwareAddress), addr));
+    }
+  m_expiry.insert (std::make_pair (r.m_link.m_expireTime, addr));
+  ScheduleTimer ();
+}
+
+void
+Neighbors::Clear ()
+{
+  for (std::set<std::pair<Time, Ipv4Address> >::const_iterator i = m_expiry.begin ();
+       i != m_expiry.end (); ++i)
+    {
+      NeighborRecord * r = m_store->Find (i->second);
+      r->m_hasLink = false;
+      m_store->Release (*r);
+    }
+  m_macIndex.clear ();
+  m_expiry.clear ();
+  m_closing.clear ();
 }
 
 /**
@@ -117,33 +165,70 @@ struct CloseNeighbor
 void
 Neighbors::Purge ()
 {
-  if (m_nb.empty ())
+  if (m_expiry.empty ())
     {
       return;
     }
 
   CloseNeighbor pred;
+  Time now = Simulator::Now ();
+  m_closed.swap (m_closing);
+  m_closing.clear ();
+  for (std::set<std::pair<Time, Ipv4Address> >::const_iterator j = m_expiry.begin ();
+       j != m_expiry.end () && j->first < now; ++j)
+    {
+      // Closed entries are already in the list
+      if (!Find (j->second)->close)
+        {
+          m_closed.push_back (j->second);
+        }
+    }
   if (!m_handleLinkFailure.IsNull ())
     {
-      for (std::vector<Neighbor>::iterator j = m_nb.begin (); j != m_nb.end (); ++j)
+      for (std::vector<Ipv4Address>::const_iterator j = m_closed.begin (); j != m_closed.end (); ++j)
         {
-          if (pred (*j))
-            {
-              NS_LOG_LOGIC ("Close link to " << j->m_neighborAddress);
-              m_handleLinkFailure (j->m_neighborAddress);
-            }
+          NS_LOG_LOGIC ("Close link to " << *j);
+          m_handleLinkFailure (*j);
         }
     }
-  m_nb.erase (std::remove_if (m_nb.begin (), m_nb.end (), pred), m_nb.end ());
-  m_ntimer.Cancel ();
-  m_ntimer.Schedule ();
+  for (std::vector<Ipv4Address>::const_iterator j = m_closed.begin (); j != m_closed.end (); ++j)
+    {
+      NeighborRecord * r = m_store->Find (*j);
+      if (r != 0 && r->m_hasLink && pred (r->m_link))
+        {
+          UnindexMac (r->m_link);
+          m_expiry.erase (std::make_pair (r->m_link.m_expireTime, *j));
+          r->m_hasLink = false;
+          m_store->Release (*r);
+        }
+    }
+  m_closed.clear ();
+  ScheduleTimer ();
+}
+
+void
+Neighbors::PurgeTimerExpire ()
+{
+  m_lastPurge = Simulator::Now ();
+  Purge ();
 }
 
 void
 Neighbors::ScheduleTimer ()
 {
+  if (m_expiry.empty ())
+    {
+      return;
+    }
+  // Expired once the expire time is in the past; keep timer driven purges apart
+  Time at = std::max (m_expiry.begin ()->first + TimeStep (1), m_lastPurge + m_ntimer.GetDelay ());
+  if (m_ntimer.IsRunning () && m_timerAt <= at)
+    {
+      return;
+    }
   m_ntimer.Cancel ();
-  m_ntimer.Schedule ();
+  m_timerAt = std::max (at, Simulator::Now ());
+  m_ntimer.Schedule (m_timerAt - Simulator::Now ());
 }
 
 void
@@ -158,6 +243,50 @@ Neighbors::DelArpCache (Ptr<ArpCache> a)
   m_arp.erase (std::remove (m_arp.begin (), m_arp.end (), a), m_arp.end ());
 }
 
+uint64_t
+Neighbors::MacKey (Mac48Address const & mac)
+{
+  uint8_t buf[6];
+  mac.CopyTo (buf);
+  uint64_t key = 0;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      key = (key << 8) | buf[i];
+    }
+  return key;
+}
+
+void
+Neighbors::UnindexMac (Neighbor const & nb)
+{
+  if (nb.m_hardwareAddress == Mac48Address ())
+    {
+      return;
+    }
+  typedef std::unordered_multimap<uint64_t, Ipv4Address>::iterator MacIterator;
+  std::pair<MacIterator, MacIterator> range = m_macIndex.equal_range (MacKey (nb.m_hardwareAddress));
+  for (MacIterator i = range.first; i != range.second; ++i)
+    {
+      if (i->second == nb.m_neighborAddress)
+        {
+          m_macIndex.erase (i);
+          return;
+        }
+    }
+}
+
+void
+Neighbors::ResolveMacAddress (Neighbor & nb)
+{
+  nb.m_hardwareAddress = LookupMacAddress (nb.m_neighborAddress);
+  if (nb.m_hardwareAddress == Mac48Address ())
+    {
+      // Not resolved yet, looked up again on the next update
+      return;
+    }
+  m_macIndex.insert (std::make_pair (MacKey (nb.m_hardwareAddress), nb.m_neighborAddress));
+}
+
 Mac48Address
 Neighbors::LookupMacAddress (Ipv4Address addr)
 {
@@ -180,16 +309,47 @@ Neighbors::ProcessTxError (WifiMacHeader const & hdr)
 {
   Mac48Address addr = hdr.GetAddr1 ();
 
-  for (std::vector<Neighbor>::iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+  typedef std::unordered_multimap<uint64_t, Ipv4Address>::const_iterator MacIterator;
+  std::pair<MacIterator, MacIterator> range = m_macIndex.equal_range (MacKey (addr));
+  for (MacIterator i = range.first; i != range.second; ++i)
     {
-      if (i->m_hardwareAddress == addr)
+      Neighbor * nb = Find (i->second);
+      if (nb != 0 && !nb->close)
         {
-          i->close = true;
+          nb->close = true;
+          m_closing.push_back (i->second);
         }
     }
   Purge ();
 }
 
+void
+Neighbors::ProcessTxOk (Neighbors * nb, uint32_t iface, Ptr<const WifiMpdu> mpdu)
+{
+  nb->ReportTxOutcome (mpdu->GetHeader ().GetAddr1 (), iface, true);
+}
+
+void
+Neighbors::ProcessTxFailed (Neighbors * nb, uint32_t iface, Mac48Address addr)
+{
+  nb->ReportTxOutcome (addr, iface, false);
+}
+
+void
+Neighbors::ReportTxOutcome (Mac48Address addr, uint32_t iface, bool ok)
+{
+  if (m_txOutcome.IsNull ())
+    {
+      return;
+    }
+  typedef std::unordered_multimap<uint64_t, Ipv4Address>::const_iterator MacIterator;
+  std::pair<MacIterator, MacIterator> range = m_macIndex.equal_range (MacKey (addr));
+  for (MacIterator i = range.first; i != range.second; ++i)
+    {
+      m_txOutcome (i->second, iface, ok);
+    }
+}
+
 }  // namespace aodv
 }  // namespace ns3
 
@@ -29,6 +29,8 @@
 #ifndef AODVNEIGHBOR_H
 #define AODVNEIGHBOR_H
 
+#include <set>
+#include <unordered_map>
 #include <vector>
 #include "ns3/simulator.h"
 #include "ns3/timer.h"
@@ -39,23 +41,37 @@
 namespace ns3 {
 
 class WifiMacHeader;
+class WifiMpdu;
 
 namespace aodv {
 
 class RoutingProtocol;
+class NeighborStore;
+struct NeighborRecord;
 
 /**
  * \ingroup aodv
  * \brief maintain list of active neighbors
+ *
+ * Entries are the link part of NeighborStore records, found by IPv4 address, with
+ * a second index by MAC address for layer 2 TX error notifications. An expiry-ordered set gives the next neighbor to
+ * expire; the purge timer is armed for it and only moved when it must fire earlier.
  */
 class Neighbors
 {
 public:
   /**
    * constructor
-   * \param delay the delay time for purging the list of neighbors
+   * \param delay the minimum time between two timer driven purges
    */
   Neighbors (Time delay);
+  /**
+   * constructor
+   * \param delay the minimum time between two timer driven purges
+   * \param store the neighbor records to keep the entries in
+   */
+  Neighbors (Time delay, NeighborStore & store);
+  ~Neighbors ();
   /// Neighbor description
   struct Neighbor
   {
@@ -101,15 +117,18 @@ public:
    * \param expire the expire time for the address
    */
   void Update (Ipv4Address addr, Time expire);
+  /**
+   * Update expire time for the record of a neighbor, add the link if it is not alive
+   * \param nb the neighbor record
+   * \param expire the expire time for the address
+   */
+  void Update (NeighborRecord & nb, Time expire);
   /// Remove all expired entries
   void Purge ();
-  /// Schedule m_ntimer.
+  /// Arm m_ntimer for the earliest neighbor expiry, unless it already fires earlier.
   void ScheduleTimer ();
   /// Remove all entries
-  void Clear ()
-  {
-    m_nb.clear ();
-  }
+  void Clear ();
 
   /**
    * Add ARP cache to be used to allow layer 2 notifications processing
@@ -129,6 +148,34 @@ public:
   {
     return m_txErrorCallback;
   }
+  /**
+   * Get callback to ProcessTxOk, for the WifiMac AckedMpdu trace of one interface
+   * \param iface the interface index of the traced device
+   * \returns the callback function
+   */
+  Callback<void, Ptr<const WifiMpdu> > GetTxOkCallback (uint32_t iface)
+  {
+    return MakeBoundCallback (&Neighbors::ProcessTxOk, this, iface);
+  }
+  /**
+   * Get callback to ProcessTxFailed, for the WifiRemoteStationManager MacTxDataFailed
+   * trace of one interface
+   * \param iface the interface index of the traced device
+   * \returns the callback function
+   */
+  Callback<void, Mac48Address> GetTxFailedCallback (uint32_t iface)
+  {
+    return MakeBoundCallback (&Neighbors::ProcessTxFailed, this, iface);
+  }
+  /**
+   * Set the callback told the outcome of every unicast data frame attempt to a neighbor
+   * \param cb the callback, with the neighbor address, the interface index and true
+   * if the frame was acknowledged
+   */
+  void SetTxOutcomeCallback (Callback<void, Ipv4Address, uint32_t, bool> cb)
+  {
+    m_txOutcome = cb;
+  }
 
   /**
    * Set link failure callback
@@ -152,10 +199,26 @@ private:
   Callback<void, Ipv4Address> m_handleLinkFailure;
   /// TX error callback
   Callback<void, WifiMacHeader const &> m_txErrorCallback;
+  /// Data frame outcome callback
+  Callback<void, Ipv4Address, uint32_t, bool> m_txOutcome;
   /// Timer for neighbor's list. Schedule Purge().
   Timer m_ntimer;
-  /// vector of entries
-  std::vector<Neighbor> m_nb;
+  /// Time m_ntimer fires at, if running
+  Time m_timerAt;
+  /// Time of the last timer driven purge
+  Time m_lastPurge;
+  /// (expire time, address) of all entries, earliest first
+  std::set<std::pair<Time, Ipv4Address> > m_expiry;
+  /// Entries closed by a TX error, not purged yet
+  std::vector<Ipv4Address> m_closing;
+  /// Records holding the entries
+  NeighborStore * m_store;
+  /// True if m_store was created by this object
+  bool m_ownStore;
+  /// IPv4 addresses of the entries by MAC address, see MacKey
+  std::unordered_multimap<uint64_t, Ipv4Address> m_macIndex;
+  /// Scratch list of closed links, reused by Purge
+  std::vector<Ipv4Address> m_closed;
   /// list of ARP cached to be used for layer 2 notifications processing
   std::vector<Ptr<ArpCache> > m_arp;
 
@@ -166,8 +229,55 @@ private:
    * \returns the MAC address for the IP address
    */
   Mac48Address LookupMacAddress (Ipv4Address addr);
+  /**
+   * Look up and index the MAC address of a neighbor which has none yet.
+   * An unresolved neighbor is looked up again on its next update.
+   * \param nb the neighbor
+   */
+  void ResolveMacAddress (Neighbor & nb);
+  /**
+   * \param mac a MAC address
+   * \returns the key of mac in m_macIndex
+   */
+  static uint64_t MacKey (Mac48Address const & mac);
+  /**
+   * Remove the MAC index entry of a neighbor
+   * \param nb the neighbor
+   */
+  void UnindexMac (Neighbor const & nb);
   /// Process layer 2 TX error notification
   void ProcessTxError (WifiMacHeader const &);
+  /**
+   * Process layer 2 notification of an acknowledged MPDU
+   * \param nb the neighbors
+   * \param iface the interface index the MPDU was sent on
+   * \param mpdu the MPDU
+   */
+  static void ProcessTxOk (Neighbors * nb, uint32_t iface, Ptr<const WifiMpdu> mpdu);
+  /**
+   * Process layer 2 notification of a failed data frame attempt
+   * \param nb the neighbors
+   * \param iface the interface index the frame was sent on
+   * \param addr the receiver MAC address
+   */
+  static void ProcessTxFailed (Neighbors * nb, uint32_t iface, Mac48Address addr);
+  /**
+   * Report a data frame outcome to m_txOutcome for every neighbor behind a MAC address
+   * \param addr the MAC address
+   * \param iface the interface index the frame was sent on
+   * \param ok true if the frame was acknowledged
+   */
+  void ReportTxOutcome (Mac48Address addr, uint32_t iface, bool ok);
+  /// Timer handler
+  void PurgeTimerExpire ();
+  /**
+   * \param addr the IP address
+   * \returns the entry of addr, or 0 if the link is not alive
+   */
+  Neighbor * Find (Ipv4Address addr);
+
+  Neighbors (Neighbors const &);
+  Neighbors & operator= (Neighbors const &);
 };
 
 }  // namespace aodv
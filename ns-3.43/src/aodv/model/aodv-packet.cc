@@ -19,10 +19,30 @@
 #include "ns3/address-utils.h"
 #include "ns3/packet.h"
 #include <cstring> // <--- WAJIB: Untuk std::memcpy
+#include <limits>
 
 namespace ns3 {
 namespace aodv {
 
+/// Write a double in network byte order
+static void
+WriteDouble (Buffer::Iterator & i, double d)
+{
+  uint64_t buffer;
+  std::memcpy (&buffer, &d, sizeof (double));
+  i.WriteHtonU64 (buffer);
+}
+
+/// Read a double written by WriteDouble
+static double
+ReadDouble (Buffer::Iterator & i)
+{
+  uint64_t buffer = i.ReadNtohU64 ();
+  double d;
+  std::memcpy (&d, &buffer, sizeof (double));
+  return d;
+}
+
 NS_OBJECT_ENSURE_REGISTERED (TypeHeader);
 
 TypeHeader::TypeHeader (MessageType t)
@@ -73,6 +93,7 @@ TypeHeader::Deserialize (Buffer::Iterator start)
     case AODVTYPE_RERR:
     case AODVTYPE_RREP_ACK:
     case AODVTYPE_LPP:
+    case AODVTYPE_PAIR_PROBE:
       {
         m_type = (MessageType) type;
         break;
@@ -95,6 +116,7 @@ TypeHeader::Print (std::ostream &os) const
     case AODVTYPE_RERR:     { os << "RERR"; break; }
     case AODVTYPE_RREP_ACK: { os << "RREP_ACK"; break; }    
     case AODVTYPE_LPP:      { os << "LPP"; break; }
+    case AODVTYPE_PAIR_PROBE: { os << "PAIR_PROBE"; break; }
     default: os << "UNKNOWN_TYPE";
     }
 }
@@ -127,8 +149,11 @@ RreqHeader::RreqHeader (uint8_t flags, uint8_t reserved, uint8_t hopCount, uint3
     m_origin (origin),
     m_originSeqNo (originSeqNo),
     m_etxMetric (etxMetric),
+    m_pathLet (std::numeric_limits<uint32_t>::max ()),
     m_position (pos),
-    m_velocity (vel)
+    m_velocity (vel),
+    m_zoneMin (Vector (0, 0, 0)),
+    m_zoneMax (Vector (0, 0, 0))
 {
 }
 
@@ -154,8 +179,9 @@ RreqHeader::GetInstanceTypeId () const
 uint32_t
 RreqHeader::GetSerializedSize () const
 {
-  // 23 bytes (Standard) + 4 bytes (ETX) + 48 bytes (Vector Pos + Vector Vel)
-  return (23 + 4 + 48); 
+  // 23 bytes (Standard) + 4 bytes (ETX) + 4 bytes (path LET, if any) + 48 bytes (Vector Pos + Vector Vel)
+  // + 1 byte (count) + 8 bytes per additional destination + 32 bytes (request zone, if any)
+  return (23 + 4 + (HasPathLet () ? 4 : 0) + 48 + 1 + 8 * m_extraDst.size () + (HasRequestZone () ? 32 : 0));
 }
 
 void
@@ -170,6 +196,10 @@ RreqHeader::Serialize (Buffer::Iterator i) const
   WriteTo (i, m_origin);
   i.WriteHtonU32 (m_originSeqNo);
   i.WriteHtonU32 (m_etxMetric);
+  if (HasPathLet ())
+    {
+      i.WriteHtonU32 (m_pathLet);
+    }
 
   // --- PERBAIKAN: Gunakan memcpy untuk menghindari strict-aliasing warning ---
   uint64_t buffer;
@@ -183,6 +213,20 @@ RreqHeader::Serialize (Buffer::Iterator i) const
   std::memcpy(&buffer, &m_velocity.x, sizeof(double)); i.WriteHtonU64(buffer);
   std::memcpy(&buffer, &m_velocity.y, sizeof(double)); i.WriteHtonU64(buffer);
   std::memcpy(&buffer, &m_velocity.z, sizeof(double)); i.WriteHtonU64(buffer);
+
+  i.WriteU8 (m_extraDst.size ());
+  for (std::vector<std::pair<Ipv4Address, uint32_t> >::const_iterator j = m_extraDst.begin (); j != m_extraDst.end (); ++j)
+    {
+      WriteTo (i, j->first);
+      i.WriteHtonU32 (j->second);
+    }
+  if (HasRequestZone ())
+    {
+      WriteDouble (i, m_zoneMin.x);
+      WriteDouble (i, m_zoneMin.y);
+      WriteDouble (i, m_zoneMax.x);
+      WriteDouble (i, m_zoneMax.y);
+    }
 }
 
 uint32_t
@@ -198,6 +242,7 @@ RreqHeader::Deserialize (Buffer::Iterator start)
   ReadFrom (i, m_origin);
   m_originSeqNo = i.ReadNtohU32 ();
   m_etxMetric = i.ReadNtohU32 ();
+  m_pathLet = HasPathLet () ? i.ReadNtohU32 () : std::numeric_limits<uint32_t>::max ();
 
   // --- PERBAIKAN: Gunakan memcpy untuk membaca double ---
   uint64_t buffer;
@@ -210,6 +255,30 @@ RreqHeader::Deserialize (Buffer::Iterator start)
   buffer = i.ReadNtohU64(); std::memcpy(&m_velocity.y, &buffer, sizeof(double));
   buffer = i.ReadNtohU64(); std::memcpy(&m_velocity.z, &buffer, sizeof(double));
 
+  uint8_t extra = i.ReadU8 ();
+  m_extraDst.clear ();
+  // A truncated or oversized list is not deserialized, RemoveHeader returns 0
+  if (extra >= 255 || i.GetRemainingSize () < 8u * extra + (HasRequestZone () ? 32 : 0))
+    {
+      return 0;
+    }
+  for (uint8_t k = 0; k < extra; ++k)
+    {
+      Ipv4Address dst;
+      ReadFrom (i, dst);
+      uint32_t seqNo = i.ReadNtohU32 ();
+      m_extraDst.push_back (std::make_pair (dst, seqNo));
+    }
+  m_zoneMin = Vector (0, 0, 0);
+  m_zoneMax = Vector (0, 0, 0);
+  if (HasRequestZone ())
+    {
+      m_zoneMin.x = ReadDouble (i);
+      m_zoneMin.y = ReadDouble (i);
+      m_zoneMax.x = ReadDouble (i);
+      m_zoneMax.y = ReadDouble (i);
+    }
+
   uint32_t dist = i.GetDistanceFrom (start);
   NS_ASSERT (dist == GetSerializedSize ());
   return dist;
@@ -221,11 +290,24 @@ RreqHeader::Print (std::ostream &os) const
   os << "RREQ ID " << m_requestID << " destination: ipv4 " << m_dst
      << " sequence number " << m_dstSeqNo << " source: ipv4 "
      << m_origin << " sequence number " << m_originSeqNo
-     << " ETX metric " << m_etxMetric
-     << " Pos(" << m_position.x << "," << m_position.y << ")"
+     << " ETX metric " << m_etxMetric;
+  if (HasPathLet ())
+    {
+      os << " path LET " << m_pathLet;
+    }
+  os << " Pos(" << m_position.x << "," << m_position.y << ")"
      << " flags:" << " Gratuitous RREP " << (*this).GetGratuitousRrep ()
      << " Destination only " << (*this).GetDestinationOnly ()
      << " Unknown sequence number " << (*this).GetUnknownSeqno ();
+  for (std::vector<std::pair<Ipv4Address, uint32_t> >::const_iterator j = m_extraDst.begin (); j != m_extraDst.end (); ++j)
+    {
+      os << " destination: ipv4 " << j->first << " sequence number " << j->second;
+    }
+  if (HasRequestZone ())
+    {
+      os << " request zone (" << m_zoneMin.x << "," << m_zoneMin.y << ")-("
+         << m_zoneMax.x << "," << m_zoneMax.y << ")";
+    }
 }
 
 std::ostream &
@@ -271,6 +353,66 @@ RreqHeader::GetUnknownSeqno () const
   return (m_flags & (1 << 3));
 }
 
+void
+RreqHeader::SetPathLet (Time t)
+{
+  m_flags |= (1 << 1);
+  int64_t ms = t.GetMilliSeconds ();
+  if (ms < 0)
+    {
+      ms = 0;
+    }
+  m_pathLet = (ms >= std::numeric_limits<uint32_t>::max ()) ? std::numeric_limits<uint32_t>::max () : uint32_t (ms);
+}
+
+Time
+RreqHeader::GetPathLet () const
+{
+  return MilliSeconds (m_pathLet);
+}
+
+bool
+RreqHeader::HasPathLet () const
+{
+  return (m_flags & (1 << 1));
+}
+
+void
+RreqHeader::AddExtraDst (Ipv4Address dst, uint32_t dstSeqNo)
+{
+  NS_ASSERT (m_extraDst.size () < 254);
+  m_extraDst.push_back (std::make_pair (dst, dstSeqNo));
+}
+
+void
+RreqHeader::SetRequestZone (Vector min, Vector max)
+{
+  m_flags |= (1 << 2);
+  m_zoneMin = min;
+  m_zoneMax = max;
+}
+
+void
+RreqHeader::ClearRequestZone ()
+{
+  m_flags &= ~(1 << 2);
+  m_zoneMin = Vector (0, 0, 0);
+  m_zoneMax = Vector (0, 0, 0);
+}
+
+bool
+RreqHeader::HasRequestZone () const
+{
+  return (m_flags & (1 << 2));
+}
+
+bool
+RreqHeader::IsInRequestZone (Vector p) const
+{
+  return !HasRequestZone ()
+         || (p.x >= m_zoneMin.x && p.x <= m_zoneMax.x && p.y >= m_zoneMin.y && p.y <= m_zoneMax.y);
+}
+
 bool
 RreqHeader::operator== (RreqHeader const & o) const
 {
@@ -278,8 +420,10 @@ RreqHeader::operator== (RreqHeader const & o) const
           && m_hopCount == o.m_hopCount && m_requestID == o.m_requestID
           && m_dst == o.m_dst && m_dstSeqNo == o.m_dstSeqNo
           && m_origin == o.m_origin && m_originSeqNo == o.m_originSeqNo
-          && m_etxMetric == o.m_etxMetric
-          && m_position.x == o.m_position.x); 
+          && m_etxMetric == o.m_etxMetric && m_pathLet == o.m_pathLet
+          && m_position.x == o.m_position.x && m_extraDst == o.m_extraDst
+          && m_zoneMin.x == o.m_zoneMin.x && m_zoneMin.y == o.m_zoneMin.y
+          && m_zoneMax.x == o.m_zoneMax.x && m_zoneMax.y == o.m_zoneMax.y);
 }
 
 //-----------------------------------------------------------------------------
@@ -296,8 +440,12 @@ RrepHeader::RrepHeader (uint8_t prefixSize, uint8_t hopCount, Ipv4Address dst,
     m_dstSeqNo (dstSeqNo),
     m_origin (origin),
     m_etxMetric (etxMetric),
+    m_pathLet (std::numeric_limits<uint32_t>::max ()),
     m_position (pos),
-    m_velocity (vel)
+    m_velocity (vel),
+    m_dstPosition (Vector (0, 0, 0)),
+    m_dstVelocity (Vector (0, 0, 0)),
+    m_dstLocationAge (0)
 {
   m_lifeTime = uint32_t (lifeTime.GetMilliSeconds ());
 }
@@ -324,8 +472,9 @@ RrepHeader::GetInstanceTypeId () const
 uint32_t
 RrepHeader::GetSerializedSize () const
 {
-  // 19 bytes (std) + 4 (ETX) + 48 (Vector x2)
-  return 19 + 4 + 48; 
+  // 19 bytes (std) + 4 (ETX) + 4 (path LET, if any) + 48 (Vector x2)
+  // + 52 (destination position, velocity and age, if any)
+  return 19 + 4 + (HasPathLet () ? 4 : 0) + 48 + (HasDstLocation () ? 52 : 0);
 }
 
 void
@@ -339,6 +488,10 @@ RrepHeader::Serialize (Buffer::Iterator i) const
   WriteTo (i, m_origin);
   i.WriteHtonU32 (m_lifeTime);
   i.WriteHtonU32 (m_etxMetric);
+  if (HasPathLet ())
+    {
+      i.WriteHtonU32 (m_pathLet);
+    }
 
   // --- PERBAIKAN: Gunakan memcpy ---
   uint64_t buffer;
@@ -350,6 +503,17 @@ RrepHeader::Serialize (Buffer::Iterator i) const
   std::memcpy(&buffer, &m_velocity.x, sizeof(double)); i.WriteHtonU64(buffer);
   std::memcpy(&buffer, &m_velocity.y, sizeof(double)); i.WriteHtonU64(buffer);
   std::memcpy(&buffer, &m_velocity.z, sizeof(double)); i.WriteHtonU64(buffer);
+
+  if (HasDstLocation ())
+    {
+      WriteDouble (i, m_dstPosition.x);
+      WriteDouble (i, m_dstPosition.y);
+      WriteDouble (i, m_dstPosition.z);
+      WriteDouble (i, m_dstVelocity.x);
+      WriteDouble (i, m_dstVelocity.y);
+      WriteDouble (i, m_dstVelocity.z);
+      i.WriteHtonU32 (m_dstLocationAge);
+    }
 }
 
 uint32_t
@@ -365,6 +529,7 @@ RrepHeader::Deserialize (Buffer::Iterator start)
   ReadFrom (i, m_origin);
   m_lifeTime = i.ReadNtohU32 ();
   m_etxMetric = i.ReadNtohU32 ();
+  m_pathLet = HasPathLet () ? i.ReadNtohU32 () : std::numeric_limits<uint32_t>::max ();
 
   // --- PERBAIKAN: Gunakan memcpy ---
   uint64_t buffer;
@@ -377,6 +542,17 @@ RrepHeader::Deserialize (Buffer::Iterator start)
   buffer = i.ReadNtohU64(); std::memcpy(&m_velocity.y, &buffer, sizeof(double));
   buffer = i.ReadNtohU64(); std::memcpy(&m_velocity.z, &buffer, sizeof(double));
 
+  if (HasDstLocation ())
+    {
+      m_dstPosition.x = ReadDouble (i);
+      m_dstPosition.y = ReadDouble (i);
+      m_dstPosition.z = ReadDouble (i);
+      m_dstVelocity.x = ReadDouble (i);
+      m_dstVelocity.y = ReadDouble (i);
+      m_dstVelocity.z = ReadDouble (i);
+      m_dstLocationAge = i.ReadNtohU32 ();
+    }
+
   uint32_t dist = i.GetDistanceFrom (start);
   NS_ASSERT (dist == GetSerializedSize ());
   return dist;
@@ -391,9 +567,18 @@ RrepHeader::Print (std::ostream &os) const
       os << " prefix size " << m_prefixSize;
     }
   os << " source ipv4 " << m_origin << " lifetime " << m_lifeTime
-     << " ETX metric " << m_etxMetric
-     << " Pos(" << m_position.x << "," << m_position.y << ")"
+     << " ETX metric " << m_etxMetric;
+  if (HasPathLet ())
+    {
+      os << " path LET " << m_pathLet;
+    }
+  os << " Pos(" << m_position.x << "," << m_position.y << ")"
      << " acknowledgment required flag " << (*this).GetAckRequired ();
+  if (HasDstLocation ())
+    {
+      os << " destination Pos(" << m_dstPosition.x << "," << m_dstPosition.y << ")"
+         << " age " << m_dstLocationAge;
+    }
 }
 
 void
@@ -409,6 +594,30 @@ RrepHeader::GetLifeTime () const
   return t;
 }
 
+void
+RrepHeader::SetPathLet (Time t)
+{
+  m_flags |= (1 << 4);
+  int64_t ms = t.GetMilliSeconds ();
+  if (ms < 0)
+    {
+      ms = 0;
+    }
+  m_pathLet = (ms >= std::numeric_limits<uint32_t>::max ()) ? std::numeric_limits<uint32_t>::max () : uint32_t (ms);
+}
+
+Time
+RrepHeader::GetPathLet () const
+{
+  return MilliSeconds (m_pathLet);
+}
+
+bool
+RrepHeader::HasPathLet () const
+{
+  return (m_flags & (1 << 4));
+}
+
 void
 RrepHeader::SetAckRequired (bool f)
 {
@@ -421,6 +630,23 @@ RrepHeader::GetAckRequired () const
   return (m_flags & (1 << 6));
 }
 
+void
+RrepHeader::SetDstLocation (Vector pos, Vector vel, Time age)
+{
+  m_flags |= (1 << 5);
+  m_dstPosition = pos;
+  m_dstVelocity = vel;
+  int64_t ms = age.GetMilliSeconds ();
+  m_dstLocationAge = (ms <= 0) ? 0
+    : (ms >= std::numeric_limits<uint32_t>::max ()) ? std::numeric_limits<uint32_t>::max () : uint32_t (ms);
+}
+
+bool
+RrepHeader::HasDstLocation () const
+{
+  return (m_flags & (1 << 5));
+}
+
 void
 RrepHeader::SetPrefixSize (uint8_t sz)
 {
@@ -439,7 +665,9 @@ RrepHeader::operator== (RrepHeader const & o) const
   return (m_flags == o.m_flags && m_prefixSize == o.m_prefixSize
           && m_hopCount == o.m_hopCount && m_dst == o.m_dst && m_dstSeqNo == o.m_dstSeqNo
           && m_origin == o.m_origin && m_lifeTime == o.m_lifeTime
-          && m_etxMetric == o.m_etxMetric);
+          && m_etxMetric == o.m_etxMetric && m_pathLet == o.m_pathLet
+          && m_dstPosition.x == o.m_dstPosition.x && m_dstPosition.y == o.m_dstPosition.y
+          && m_dstLocationAge == o.m_dstLocationAge);
 }
 
 void
@@ -526,6 +754,78 @@ operator<< (std::ostream & os, RrepAckHeader const & h )
   return os;
 }
 
+//-----------------------------------------------------------------------------
+// PAIR PROBE
+//-----------------------------------------------------------------------------
+
+PairProbeHeader::PairProbeHeader (uint32_t id, bool second)
+  : m_id (id),
+    m_second (second)
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (PairProbeHeader);
+
+TypeId
+PairProbeHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::aodv::PairProbeHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<PairProbeHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+PairProbeHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+PairProbeHeader::GetSerializedSize () const
+{
+  return 5;
+}
+
+void
+PairProbeHeader::Serialize (Buffer::Iterator i ) const
+{
+  i.WriteHtonU32 (m_id);
+  i.WriteU8 (m_second ? 1 : 0);
+}
+
+uint32_t
+PairProbeHeader::Deserialize (Buffer::Iterator start )
+{
+  Buffer::Iterator i = start;
+  m_id = i.ReadNtohU32 ();
+  m_second = (i.ReadU8 () != 0);
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+PairProbeHeader::Print (std::ostream &os ) const
+{
+  os << "Pair " << m_id << (m_second ? " second" : " first");
+}
+
+bool
+PairProbeHeader::operator== (PairProbeHeader const & o ) const
+{
+  return m_id == o.m_id && m_second == o.m_second;
+}
+
+std::ostream &
+operator<< (std::ostream & os, PairProbeHeader const & h )
+{
+  h.Print (os);
+  return os;
+}
+
 //-----------------------------------------------------------------------------
 // RERR
 //-----------------------------------------------------------------------------
@@ -674,7 +974,8 @@ LppHeader::LppHeader (Vector pos, Vector vel)
   : m_lppId (0), 
     m_originSeqno (0),
     m_position (pos),
-    m_velocity (vel)
+    m_velocity (vel),
+    m_load (0)
 {
 }
 
@@ -700,8 +1001,8 @@ LppHeader::GetInstanceTypeId () const
 uint32_t
 LppHeader::GetSerializedSize () const
 {
-  // 10 + 5*N (Standard) + 48 (Vector x2)
-  return (10 + 5 * GetNumberNeighbors () + 48);
+  // 10 + 5*N (Standard) + 48 (Vector x2) + 2 (Load)
+  return (10 + 5 * GetNumberNeighbors () + 48 + 2);
 }
 
 void
@@ -721,6 +1022,7 @@ LppHeader::Serialize (Buffer::Iterator i ) const
   std::memcpy(&buffer, &m_velocity.x, sizeof(double)); i.WriteHtonU64(buffer);
   std::memcpy(&buffer, &m_velocity.y, sizeof(double)); i.WriteHtonU64(buffer);
   std::memcpy(&buffer, &m_velocity.z, sizeof(double)); i.WriteHtonU64(buffer);
+  i.WriteHtonU16 (m_load);
 
   i.WriteU8 (GetNumberNeighbors ());
   std::map<Ipv4Address, uint8_t>::const_iterator j;
@@ -749,6 +1051,7 @@ LppHeader::Deserialize (Buffer::Iterator start )
   buffer = i.ReadNtohU64(); std::memcpy(&m_velocity.x, &buffer, sizeof(double));
   buffer = i.ReadNtohU64(); std::memcpy(&m_velocity.y, &buffer, sizeof(double));
   buffer = i.ReadNtohU64(); std::memcpy(&m_velocity.z, &buffer, sizeof(double));
+  m_load = i.ReadNtohU16 ();
 
   uint8_t numberNeighbors = i.ReadU8 ();
   m_neighborsLppCnt.clear ();
@@ -772,6 +1075,7 @@ LppHeader::Print (std::ostream &os ) const
   os << "Lpp ID: " << (uint16_t)m_lppId << " Origin IP: " << m_originAddr
      << " Origin Seq: " << m_originSeqno
      << " Pos(" << m_position.x << "," << m_position.y << ")"
+     << " Load: " << m_load
      << " Num Neighbors: " <<  (*this).GetNumberNeighbors ();
   
   os << " Neighbors: ";
@@ -815,7 +1119,7 @@ LppHeader::operator== (LppHeader const & o ) const
 {
   if (m_lppId != o.m_lppId || m_originAddr != o.m_originAddr || 
       m_originSeqno != o.m_originSeqno || GetNumberNeighbors () != o.GetNumberNeighbors () ||
-      m_position.x != o.m_position.x)
+      m_position.x != o.m_position.x || m_load != o.m_load)
   {
     return false;
   }  
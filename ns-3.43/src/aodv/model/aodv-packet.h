@@ -11,6 +11,7 @@
 #include "ns3/enum.h"
 #include "ns3/ipv4-address.h"
 #include <map>
+#include <vector>
 #include "ns3/nstime.h"
 #include "ns3/vector.h" // <--- TAMBAHAN 1: Wajib untuk Vector (Posisi/Kecepatan)
 
@@ -27,7 +28,8 @@ enum MessageType
   AODVTYPE_RREP  = 2,   //!< AODVTYPE_RREP
   AODVTYPE_RERR  = 3,   //!< AODVTYPE_RERR
   AODVTYPE_RREP_ACK = 4, //!< AODVTYPE_RREP_ACK
-  AODVTYPE_LPP = 5      //!< AODVTYPE_LPP
+  AODVTYPE_LPP = 5,     //!< AODVTYPE_LPP
+  AODVTYPE_PAIR_PROBE = 6 //!< AODVTYPE_PAIR_PROBE
 };
 
 /**
@@ -90,6 +92,35 @@ public:
   uint32_t GetOriginSeqno () const { return m_originSeqNo; }
   void SetEtx (uint32_t s) { m_etxMetric = s; }
   uint32_t GetEtx () const { return m_etxMetric; }
+  /**
+   * Minimum link expiration time along the reverse path (ms precision).
+   * Only carried once set, GetPathLet returns the largest value otherwise.
+   */
+  void SetPathLet (Time t);
+  Time GetPathLet () const;
+  bool HasPathLet () const;
+
+  /**
+   * Additional destinations searched by the same flood, each answered on its own.
+   * A sequence number of 0 means unknown. A RREQ has at most 255 destinations.
+   */
+  void AddExtraDst (Ipv4Address dst, uint32_t dstSeqNo);
+  uint8_t GetExtraDstCount () const { return m_extraDst.size (); }
+  Ipv4Address GetExtraDst (uint8_t i) const { return m_extraDst[i].first; }
+  uint32_t GetExtraDstSeqno (uint8_t i) const { return m_extraDst[i].second; }
+  void ClearExtraDst () { m_extraDst.clear (); }
+
+  /**
+   * Limit rebroadcasts to the nodes inside a rectangle of the x-y plane,
+   * location-aided discovery
+   * \param min the corner with the smallest coordinates
+   * \param max the corner with the largest coordinates
+   */
+  void SetRequestZone (Vector min, Vector max);
+  void ClearRequestZone ();
+  bool HasRequestZone () const;
+  /// \returns true if there is no request zone or p is inside it
+  bool IsInRequestZone (Vector p) const;
 
   // --- TAMBAHAN UNTUK LET (RREQ) ---
   void SetPosition (Vector p) { m_position = p; }
@@ -117,10 +148,17 @@ private:
   Ipv4Address    m_origin;          
   uint32_t       m_originSeqNo;    
   uint32_t       m_etxMetric;       
+  uint32_t       m_pathLet;           ///< Minimum path LET in ms, UINT32_MAX if unbounded
   
   // --- DATA BARU ---
   Vector         m_position; // Posisi Pengirim
   Vector         m_velocity; // Kecepatan Pengirim
+
+  /// Additional destinations and their sequence numbers, at most 255
+  std::vector<std::pair<Ipv4Address, uint32_t> > m_extraDst;
+  /// Request zone corners, only sent if the zone flag is set
+  Vector         m_zoneMin;
+  Vector         m_zoneMax;
 };
 
 std::ostream & operator<< (std::ostream & os, RreqHeader const &);
@@ -158,6 +196,13 @@ public:
   Time GetLifeTime () const;
   void SetEtx (uint32_t s) { m_etxMetric = s; }
   uint32_t GetEtx () const { return m_etxMetric; }
+  /**
+   * Minimum link expiration time along the path (ms precision).
+   * Only carried once set, GetPathLet returns the largest value otherwise.
+   */
+  void SetPathLet (Time t);
+  Time GetPathLet () const;
+  bool HasPathLet () const;
 
   // --- TAMBAHAN UNTUK LET (RREP) ---
   void SetPosition (Vector p) { m_position = p; }
@@ -166,6 +211,18 @@ public:
   Vector GetVelocity () const { return m_velocity; }
   // ---------------------------------
 
+  /**
+   * Last known position and velocity of the destination, unchanged along the path
+   * \param pos the position
+   * \param vel the velocity
+   * \param age time since the destination was at pos (ms precision)
+   */
+  void SetDstLocation (Vector pos, Vector vel, Time age);
+  bool HasDstLocation () const;
+  Vector GetDstPosition () const { return m_dstPosition; }
+  Vector GetDstVelocity () const { return m_dstVelocity; }
+  Time GetDstLocationAge () const { return MilliSeconds (m_dstLocationAge); }
+
   // Flags
   void SetAckRequired (bool f);
   bool GetAckRequired () const;
@@ -183,10 +240,16 @@ private:
   Ipv4Address      m_origin;            
   uint32_t       m_lifeTime;          
   uint32_t       m_etxMetric;         
+  uint32_t       m_pathLet;           ///< Minimum path LET in ms, UINT32_MAX if unbounded
   
   // --- DATA BARU ---
   Vector         m_position;
   Vector         m_velocity;
+
+  /// Destination location, only sent if the location flag is set
+  Vector         m_dstPosition;
+  Vector         m_dstVelocity;
+  uint32_t       m_dstLocationAge;    ///< ms
 };
 
 std::ostream & operator<< (std::ostream & os, RrepHeader const &);
@@ -212,6 +275,36 @@ private:
 
 std::ostream & operator<< (std::ostream & os, RrepAckHeader const &);
 
+/**
+* \ingroup aodv
+* \brief Packet-pair probe, sent back to back as a small and a large unicast packet
+*/
+class PairProbeHeader : public Header
+{
+public:
+  /**
+   * constructor
+   * \param id the pair id
+   * \param second false for the small first packet, true for the large second one
+   */
+  PairProbeHeader (uint32_t id = 0, bool second = false);
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  uint32_t GetId () const { return m_id; }
+  bool IsSecond () const { return m_second; }
+  bool operator== (PairProbeHeader const & o) const;
+private:
+  uint32_t      m_id;                 ///< Pair id, the same in both packets
+  bool          m_second;             ///< Second (large) packet of the pair
+};
+
+std::ostream & operator<< (std::ostream & os, PairProbeHeader const &);
+
 /**
 * \ingroup aodv
 * \brief Route Error (RERR) Message Format
@@ -275,6 +368,10 @@ public:
   Vector GetVelocity () const { return m_velocity; }
   // --------------------------------
 
+  // --- BEBAN NODE: paket antre di MAC dan di buffer discovery ---
+  void SetLoad (uint16_t load) { m_load = load; }
+  uint16_t GetLoad () const { return m_load; }
+
   bool AddToNeighborsList (Ipv4Address neighbor, uint8_t lppCnt);
   bool RemoveFromNeighborsList (std::pair<Ipv4Address, uint8_t> & un);
   void ClearNeighborsList ();
@@ -288,6 +385,7 @@ private:
   // --- DATA BARU ---
   Vector        m_position;
   Vector        m_velocity;
+  uint16_t      m_load;
 
   std::map<Ipv4Address, uint8_t> m_neighborsLppCnt;
 };
@@ -44,27 +44,39 @@ RequestQueue::GetSize ()
   return m_queue.size ();
 }
 
+void
+RequestQueue::Clear ()
+{
+  m_purgeTimer.Cancel ();
+  m_buckets.clear ();
+  m_uids.clear ();
+  m_queue.clear ();
+}
+
 bool
 RequestQueue::Enqueue (QueueEntry & entry)
 {
   Purge ();
-  for (std::vector<QueueEntry>::const_iterator i = m_queue.begin (); i
-       != m_queue.end (); ++i)
+  Ipv4Address dst = entry.GetIpv4Header ().GetDestination ();
+  UidDst key (entry.GetPacket ()->GetUid (), dst);
+  if (m_uids.find (key) != m_uids.end ())
     {
-      if ((i->GetPacket ()->GetUid () == entry.GetPacket ()->GetUid ())
-          && (i->GetIpv4Header ().GetDestination ()
-              == entry.GetIpv4Header ().GetDestination ()))
-        {
-          return false;
-        }
+      return false;
     }
   entry.SetExpireTime (m_queueTimeout);
-  if (m_queue.size () == m_maxLen)
+  while (!m_queue.empty () && m_queue.size () >= m_maxLen)
     {
       Drop (m_queue.front (), "Drop the most aged packet"); // Drop the most aged packet
-      m_queue.erase (m_queue.begin ());
+      Erase (m_queue.begin ());
     }
   m_queue.push_back (entry);
+  m_buckets[dst].push_back (--m_queue.end ());
+  m_uids.insert (key);
+  if (!m_purgeTimer.IsRunning ())
+    {
+      // Expired as soon as the remaining time is negative
+      m_purgeTimer.Schedule (m_queue.front ().GetExpireTime () + TimeStep (1));
+    }
   return true;
 }
 
@@ -73,84 +85,92 @@ RequestQueue::DropPacketWithDst (Ipv4Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
   Purge ();
-  for (std::vector<QueueEntry>::iterator i = m_queue.begin (); i
-       != m_queue.end (); ++i)
+  std::unordered_map<Ipv4Address, DstBucket, Ipv4AddressHash>::iterator b = m_buckets.find (dst);
+  if (b == m_buckets.end ())
     {
-      if (IsEqual (*i, dst))
-        {
-          Drop (*i, "DropPacketWithDst ");
-        }
+      return;
+    }
+  DstBucket bucket;
+  bucket.swap (b->second);
+  m_buckets.erase (b);
+  for (DstBucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+    {
+      Drop (**i, "DropPacketWithDst ");
+      m_uids.erase (UidDst ((*i)->GetPacket ()->GetUid (), dst));
+      m_queue.erase (*i);
+    }
+  if (m_queue.empty ())
+    {
+      m_purgeTimer.Cancel ();
     }
-  m_queue.erase (std::remove_if (m_queue.begin (), m_queue.end (),
-                                 std::bind2nd (std::ptr_fun (RequestQueue::IsEqual), dst)), m_queue.end ());
 }
 
 bool
 RequestQueue::Dequeue (Ipv4Address dst, QueueEntry & entry)
 {
   Purge ();
-  for (std::vector<QueueEntry>::iterator i = m_queue.begin (); i != m_queue.end (); ++i)
+  std::unordered_map<Ipv4Address, DstBucket, Ipv4AddressHash>::iterator b = m_buckets.find (dst);
+  if (b == m_buckets.end ())
     {
-      if (i->GetIpv4Header ().GetDestination () == dst)
-        {
-          entry = *i;
-          m_queue.erase (i);
-          return true;
-        }
+      return false;
     }
-  return false;
+  entry = *b->second.front ();
+  Erase (b->second.front ());
+  return true;
 }
 
 bool
 RequestQueue::Find (Ipv4Address dst)
 {
-  for (std::vector<QueueEntry>::const_iterator i = m_queue.begin (); i
-       != m_queue.end (); ++i)
+  return m_buckets.find (dst) != m_buckets.end ();
+}
+
+void
+RequestQueue::Erase (EntryList::iterator i)
+{
+  Ipv4Address dst = i->GetIpv4Header ().GetDestination ();
+  std::unordered_map<Ipv4Address, DstBucket, Ipv4AddressHash>::iterator b = m_buckets.find (dst);
+  NS_ASSERT (b != m_buckets.end ());
+  // Entries almost always leave their bucket from the front
+  DstBucket::iterator j = std::find (b->second.begin (), b->second.end (), i);
+  NS_ASSERT (j != b->second.end ());
+  b->second.erase (j);
+  if (b->second.empty ())
+    {
+      m_buckets.erase (b);
+    }
+  m_uids.erase (UidDst (i->GetPacket ()->GetUid (), dst));
+  m_queue.erase (i);
+  if (m_queue.empty ())
     {
-      if (i->GetIpv4Header ().GetDestination () == dst)
-        {
-          return true;
-        }
+      m_purgeTimer.Cancel ();
     }
-  return false;
 }
 
-/**
- * \brief IsExpired structure
- */
-struct IsExpired
+void
+RequestQueue::Purge ()
 {
-  bool
-  /**
-   * Check if the entry is expired
-   *
-   * \param e QueueEntry entry
-   * \return true if expired, false otherwise
-   */
-  operator() (QueueEntry const & e) const
-  {
-    return (e.GetExpireTime () < Seconds (0));
-  }
-};
+  // Entries share one timeout, so the expired ones are at the head
+  while (!m_queue.empty () && m_queue.front ().GetExpireTime () < Seconds (0))
+    {
+      Drop (m_queue.front (), "Drop outdated packet ");
+      Erase (m_queue.begin ());
+    }
+}
 
 void
-RequestQueue::Purge ()
+RequestQueue::PurgeTimerExpire ()
 {
-  IsExpired pred;
-  for (std::vector<QueueEntry>::iterator i = m_queue.begin (); i
-       != m_queue.end (); ++i)
+  Purge ();
+  if (!m_queue.empty ())
     {
-      if (pred (*i))
-        {
-          Drop (*i, "Drop outdated packet ");
-        }
+      // The head may have been dequeued before expiring; wait for the new one
+      m_purgeTimer.Schedule (std::max (m_queue.front ().GetExpireTime (), Seconds (0)) + TimeStep (1));
     }
-  m_queue.erase (std::remove_if (m_queue.begin (), m_queue.end (), pred),
-                 m_queue.end ());
 }
 
 void
-RequestQueue::Drop (QueueEntry en, std::string reason)
+RequestQueue::Drop (QueueEntry const & en, std::string reason)
 {
   NS_LOG_LOGIC (reason << en.GetPacket ()->GetUid () << " " << en.GetIpv4Header ().GetDestination ());
   en.GetErrorCallback () (en.GetPacket (), en.GetIpv4Header (),
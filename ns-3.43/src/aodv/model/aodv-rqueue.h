@@ -28,9 +28,14 @@
 #ifndef AODV_RQUEUE_H
 #define AODV_RQUEUE_H
 
-#include <vector>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include "ns3/ipv4-address.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/simulator.h"
+#include "ns3/timer.h"
 
 
 namespace ns3 {
@@ -176,6 +181,13 @@ private:
  * \brief AODV route request queue
  *
  * Since AODV is an on demand routing we queue requests while looking for route.
+ *
+ * Entries are kept in one list in arrival order, which is also expiry order since
+ * all entries share the same timeout. Each destination has a FIFO of positions in
+ * that list and a hash set indexes (packet uid, destination) pairs, so enqueue,
+ * dequeue and eviction are O(1) and dropping k packets of a destination is O(k).
+ * Expired entries are dropped from the head only, by a single timer armed at the
+ * expiry of the oldest entry.
  */
 class RequestQueue
 {
@@ -188,8 +200,10 @@ public:
    */
   RequestQueue (uint32_t maxLen, Time routeToQueueTimeout)
     : m_maxLen (maxLen),
-      m_queueTimeout (routeToQueueTimeout)
+      m_queueTimeout (routeToQueueTimeout),
+      m_purgeTimer (Timer::CANCEL_ON_DESTROY)
   {
+    m_purgeTimer.SetFunction (&RequestQueue::PurgeTimerExpire, this);
   }
   /**
    * Push entry in queue, if there is no entry with the same packet and destination address in queue.
@@ -221,6 +235,8 @@ public:
    * \returns the number of entries
    */
   uint32_t GetSize ();
+  /// Remove all entries without notifying their error callbacks
+  void Clear ();
 
   // Fields
   /**
@@ -248,7 +264,9 @@ public:
     return m_queueTimeout;
   }
   /**
-   * Set queue timeout
+   * Set queue timeout. Entries already queued keep their expiry time; if the
+   * timeout is reduced, they may hold back the drop of newer entries until they
+   * expire themselves.
    * \param t The queue timeout
    */
   void SetQueueTimeout (Time t)
@@ -257,30 +275,52 @@ public:
   }
 
 private:
+  /// Queue entries, oldest first
+  typedef std::list<QueueEntry> EntryList;
+  /// Positions of the entries of one destination, oldest first
+  typedef std::deque<EntryList::iterator> DstBucket;
+  /// Packet uid and destination, identifies a queued entry
+  typedef std::pair<uint64_t, Ipv4Address> UidDst;
+  /// Hash of UidDst
+  struct UidDstHash
+  {
+    /**
+     * \param k the key
+     * \return the hash
+     */
+    size_t operator() (UidDst const & k) const
+    {
+      return std::hash<uint64_t> () (k.first) ^ (k.second.Get () * 2654435761u);
+    }
+  };
+
   /// The queue
-  std::vector<QueueEntry> m_queue;
+  EntryList m_queue;
+  /// Per destination FIFO buckets
+  std::unordered_map<Ipv4Address, DstBucket, Ipv4AddressHash> m_buckets;
+  /// Queued (packet uid, destination) pairs, for duplicate detection
+  std::unordered_set<UidDst, UidDstHash> m_uids;
   /// Remove all expired entries
   void Purge ();
+  /// Drop expired entries and arm the timer for the next expiry
+  void PurgeTimerExpire ();
+  /**
+   * Remove an entry from the queue and from the indexes
+   * \param i the entry
+   */
+  void Erase (EntryList::iterator i);
   /**
    * Notify that packet is dropped from queue by timeout
    * \param en the queue entry to drop
    * \param reason the reason to drop the entry
    */
-  void Drop (QueueEntry en, std::string reason);
+  void Drop (QueueEntry const & en, std::string reason);
   /// The maximum number of packets that we allow a routing protocol to buffer.
   uint32_t m_maxLen;
   /// The maximum period of time that a routing protocol is allowed to buffer a packet for, seconds.
   Time m_queueTimeout;
-  /**
-   * Determine if queue matches a destination address
-   * \param en The queue entry
-   * \param dst The destination IPv4 address
-   * \returns true if the queue entry matches the destination address
-   */
-  static bool IsEqual (QueueEntry en, const Ipv4Address dst)
-  {
-    return (en.GetIpv4Header ().GetDestination () == dst);
-  }
+  /// Fires just after the oldest entry expires
+  Timer m_purgeTimer;
 };
 
 
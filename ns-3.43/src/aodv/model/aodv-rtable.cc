@@ -29,6 +29,7 @@
 #include "aodv-rtable.h"
 #include <algorithm>
 #include <iomanip>
+#include <limits>
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 
@@ -54,7 +55,10 @@ RoutingTableEntry::RoutingTableEntry (Ptr<NetDevice> dev, Ipv4Address dst, bool
     m_reqCount (0),
     m_blackListState (false),
     m_blackListTimeout (Simulator::Now ()),
-    m_etx (etx) // --- PERBAIKAN: Menggunakan m_etx sesuai header ---
+    m_etx (etx), // --- PERBAIKAN: Menggunakan m_etx sesuai header ---
+    m_pathLetExpire (Simulator::GetMaximumSimulationTime ()),
+    m_hasDstLocation (false),
+    m_dstLocationTime (Seconds (0))
 {
   m_ipv4Route = Create<Ipv4Route> ();
   m_ipv4Route->SetDestination (dst);
@@ -171,6 +175,15 @@ RoutingTableEntry::Invalidate (Time badLinkLifetime)
   m_lifeTime = badLinkLifetime + Simulator::Now ();
 }
 
+void
+RoutingTableEntry::SetDstLocation (Vector pos, Vector vel, Time age)
+{
+  m_hasDstLocation = true;
+  m_dstPosition = pos;
+  m_dstVelocity = vel;
+  m_dstLocationTime = Simulator::Now () - age;
+}
+
 void
 RoutingTableEntry::Print (Ptr<OutputStreamWrapper> stream) const
 {
@@ -208,7 +221,9 @@ RoutingTableEntry::Print (Ptr<OutputStreamWrapper> stream) const
  */
 
 RoutingTable::RoutingTable (Time t)
-  : m_badLinkLifetime (t)
+  : m_badLinkLifetime (t),
+    m_generation (0),
+    m_refreshGranularity (MilliSeconds (100))
 {
 }
 
@@ -252,8 +267,10 @@ RoutingTable::DeleteRoute (Ipv4Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
   Purge ();
+  m_alternateEntry.erase (dst);
   if (m_ipv4AddressEntry.erase (dst) != 0)
     {
+      InvalidateRouteCache ();
       NS_LOG_LOGIC ("Route deletion to " << dst << " successful");
       return true;
     }
@@ -292,6 +309,31 @@ RoutingTable::Update (RoutingTableEntry & rt)
       NS_LOG_LOGIC ("Route update to " << rt.GetDestination () << " set RreqCnt to 0");
       i->second.SetRreqCnt (0);
     }
+  if (!m_alternateEntry.empty ())
+    {
+      std::map<Ipv4Address, std::vector<RoutingTableEntry> >::iterator a =
+        m_alternateEntry.find (rt.GetDestination ());
+      if (a != m_alternateEntry.end ())
+        {
+          // Alternates older than the primary are no longer loop free
+          std::vector<RoutingTableEntry> & paths = a->second;
+          for (std::vector<RoutingTableEntry>::iterator j = paths.begin (); j != paths.end (); )
+            {
+              if (int32_t (j->GetSeqNo () - rt.GetSeqNo ()) < 0 || j->GetNextHop () == rt.GetNextHop ())
+                {
+                  j = paths.erase (j);
+                }
+              else
+                {
+                  ++j;
+                }
+            }
+          if (paths.empty ())
+            {
+              m_alternateEntry.erase (a);
+            }
+        }
+    }
   return true;
 }
 
@@ -344,6 +386,7 @@ RoutingTable::InvalidateRoutesWithDst (const std::map<Ipv4Address, uint32_t> & u
             {
               NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
               i->second.Invalidate (m_badLinkLifetime);
+              m_alternateEntry.erase (i->first);
             }
         }
     }
@@ -364,7 +407,9 @@ RoutingTable::DeleteAllRoutesFromInterface (Ipv4InterfaceAddress iface)
         {
           std::map<Ipv4Address, RoutingTableEntry>::iterator tmp = i;
           ++i;
+          m_alternateEntry.erase (tmp->first);
           m_ipv4AddressEntry.erase (tmp);
+          InvalidateRouteCache ();
         }
       else
         {
@@ -381,6 +426,32 @@ RoutingTable::Purge ()
     {
       return;
     }
+  for (std::map<Ipv4Address, std::vector<RoutingTableEntry> >::iterator a =
+         m_alternateEntry.begin (); a != m_alternateEntry.end (); )
+    {
+      std::vector<RoutingTableEntry> & paths = a->second;
+      for (std::vector<RoutingTableEntry>::iterator j = paths.begin (); j != paths.end (); )
+        {
+          if (j->GetLifeTime () < Seconds (0) || j->GetPathLet () < Seconds (0))
+            {
+              j = paths.erase (j);
+            }
+          else
+            {
+              ++j;
+            }
+        }
+      if (paths.empty ())
+        {
+          std::map<Ipv4Address, std::vector<RoutingTableEntry> >::iterator tmp = a;
+          ++a;
+          m_alternateEntry.erase (tmp);
+        }
+      else
+        {
+          ++a;
+        }
+    }
   for (std::map<Ipv4Address, RoutingTableEntry>::iterator i =
          m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); )
     {
@@ -391,11 +462,13 @@ RoutingTable::Purge ()
               std::map<Ipv4Address, RoutingTableEntry>::iterator tmp = i;
               ++i;
               m_ipv4AddressEntry.erase (tmp);
+              InvalidateRouteCache ();
             }
           else if (i->second.GetFlag () == VALID)
             {
               NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
               i->second.Invalidate (m_badLinkLifetime);
+              m_alternateEntry.erase (i->first);
               ++i;
             }
           else
@@ -465,6 +538,296 @@ RoutingTable::MarkLinkAsUnidirectional (Ipv4Address neighbor, Time blacklistTime
   return true;
 }
 
+bool
+RoutingTable::RefreshLifeTime (Ipv4Address dst, Time lifetime)
+{
+  NS_LOG_FUNCTION (this << dst << lifetime);
+  std::map<Ipv4Address, RoutingTableEntry>::iterator i = m_ipv4AddressEntry.find (dst);
+  if (i == m_ipv4AddressEntry.end () || i->second.GetFlag () != VALID)
+    {
+      return false;
+    }
+  Time left = i->second.GetLifeTime ();
+  if (left < Seconds (0))
+    {
+      // Expired, the next purge invalidates it
+      return false;
+    }
+  i->second.SetRreqCnt (0);
+  if (left < lifetime)
+    {
+      i->second.SetLifeTime (lifetime);
+    }
+  return true;
+}
+
+RoutingTableEntry *
+RoutingTable::FindEntry (Ipv4Address dst)
+{
+  std::map<Ipv4Address, RoutingTableEntry>::iterator i = m_ipv4AddressEntry.find (dst);
+  return (i == m_ipv4AddressEntry.end ()) ? 0 : &i->second;
+}
+
+void
+RoutingTable::SetRouteCacheSize (uint32_t size)
+{
+  RouteCacheSlot empty;
+  empty.m_entry = 0;
+  empty.m_nextHopEntry = 0;
+  empty.m_generation = m_generation - 1;
+  m_routeCache.assign (size, empty);
+}
+
+Ptr<Ipv4Route>
+RoutingTable::LookupValidRouteCached (Ipv4Address dst, Time lifetime, bool & refreshed)
+{
+  NS_LOG_FUNCTION (this << dst);
+  refreshed = false;
+  RouteCacheSlot * slot = 0;
+  RoutingTableEntry * entry = 0;
+  RoutingTableEntry * nextHopEntry = 0;
+  if (!m_routeCache.empty ())
+    {
+      slot = &m_routeCache[(dst.Get () * 2654435761u) % m_routeCache.size ()];
+      if (slot->m_generation == m_generation && slot->m_dst == dst)
+        {
+          entry = slot->m_entry;
+          nextHopEntry = slot->m_nextHopEntry;
+        }
+    }
+  if (entry == 0)
+    {
+      std::map<Ipv4Address, RoutingTableEntry>::iterator i = m_ipv4AddressEntry.find (dst);
+      if (i == m_ipv4AddressEntry.end ())
+        {
+          return 0;
+        }
+      entry = &i->second;
+    }
+  Time now = Simulator::Now ();
+  if (entry->GetFlag () != VALID || entry->GetLifeTime () < Seconds (0))
+    {
+      return 0;
+    }
+  // The next hop may have changed since the slot was filled
+  if (nextHopEntry == 0 || nextHopEntry->GetDestination () != entry->GetNextHop ())
+    {
+      std::map<Ipv4Address, RoutingTableEntry>::iterator n = m_ipv4AddressEntry.find (entry->GetNextHop ());
+      nextHopEntry = (n == m_ipv4AddressEntry.end ()) ? 0 : &n->second;
+    }
+  if (entry->GetHop () != 1 && !m_alternateEntry.empty ()
+      && m_alternateEntry.find (dst) != m_alternateEntry.end ()
+      && (nextHopEntry == 0 || nextHopEntry->GetFlag () != VALID
+          || nextHopEntry->GetEtx () == std::numeric_limits<uint32_t>::max ()))
+    {
+      // Let the caller fail over to an alternate path
+      return 0;
+    }
+  if (slot != 0 && (slot->m_dst != dst || slot->m_generation != m_generation || slot->m_entry != entry))
+    {
+      slot->m_dst = dst;
+      slot->m_entry = entry;
+      slot->m_generation = m_generation;
+      slot->m_nextRefresh = now;
+    }
+  if (slot == 0 || now >= slot->m_nextRefresh)
+    {
+      Time lt = lifetime + m_refreshGranularity;
+      entry->SetRreqCnt (0);
+      if (entry->GetLifeTime () < lt)
+        {
+          entry->SetLifeTime (lt);
+        }
+      if (nextHopEntry != 0 && nextHopEntry->GetFlag () == VALID && nextHopEntry->GetLifeTime () >= Seconds (0))
+        {
+          nextHopEntry->SetRreqCnt (0);
+          if (nextHopEntry->GetLifeTime () < lt)
+            {
+              nextHopEntry->SetLifeTime (lt);
+            }
+        }
+      if (slot != 0)
+        {
+          slot->m_nextRefresh = now + m_refreshGranularity;
+        }
+      refreshed = true;
+    }
+  if (slot != 0)
+    {
+      slot->m_nextHopEntry = nextHopEntry;
+    }
+  return entry->GetRoute ();
+}
+
+bool
+RoutingTable::IsBetterPath (RoutingTableEntry const & a, RoutingTableEntry const & b)
+{
+  if (a.GetEtx () != b.GetEtx ())
+    {
+      return a.GetEtx () < b.GetEtx ();
+    }
+  if (a.GetPathLet () != b.GetPathLet ())
+    {
+      return a.GetPathLet () > b.GetPathLet ();
+    }
+  return a.GetHop () < b.GetHop ();
+}
+
+bool
+RoutingTable::IsUsableNextHop (Ipv4Address nextHop) const
+{
+  std::map<Ipv4Address, RoutingTableEntry>::const_iterator i =
+    m_ipv4AddressEntry.find (nextHop);
+  return (i != m_ipv4AddressEntry.end () && i->second.GetFlag () == VALID
+          && i->second.GetEtx () != std::numeric_limits<uint32_t>::max ());
+}
+
+bool
+RoutingTable::AddAlternateRoute (RoutingTableEntry const & rt, uint32_t maxPaths)
+{
+  NS_LOG_FUNCTION (this << rt.GetDestination () << rt.GetNextHop ());
+  if (maxPaths < 2 || rt.GetEtx () == std::numeric_limits<uint32_t>::max ())
+    {
+      return false;
+    }
+  std::map<Ipv4Address, RoutingTableEntry>::const_iterator primary =
+    m_ipv4AddressEntry.find (rt.GetDestination ());
+  if (primary == m_ipv4AddressEntry.end ()
+      || primary->second.GetFlag () != VALID
+      || !primary->second.GetValidSeqNo ()
+      || int32_t (rt.GetSeqNo () - primary->second.GetSeqNo ()) < 0
+      || primary->second.GetNextHop () == rt.GetNextHop ()
+      || (rt.GetSeqNo () == primary->second.GetSeqNo () && rt.GetHop () > primary->second.GetHop ()))
+    {
+      NS_LOG_LOGIC ("Alternate route to " << rt.GetDestination () << " via " << rt.GetNextHop () << " rejected");
+      return false;
+    }
+
+  std::vector<RoutingTableEntry> & paths = m_alternateEntry[rt.GetDestination ()];
+  for (std::vector<RoutingTableEntry>::iterator j = paths.begin (); j != paths.end (); ++j)
+    {
+      if (j->GetNextHop () == rt.GetNextHop ())
+        {
+          if (!IsBetterPath (rt, *j))
+            {
+              // Keep the old path but refresh its lifetime
+              j->SetLifeTime (std::max (j->GetLifeTime (), rt.GetLifeTime ()));
+              return false;
+            }
+          paths.erase (j);
+          break;
+        }
+    }
+  std::vector<RoutingTableEntry>::iterator pos = paths.begin ();
+  while (pos != paths.end () && !IsBetterPath (rt, *pos))
+    {
+      ++pos;
+    }
+  paths.insert (pos, rt);
+  if (paths.size () > maxPaths - 1)
+    {
+      paths.erase (paths.begin () + (maxPaths - 1), paths.end ());
+    }
+  NS_LOG_LOGIC ("Keep " << paths.size () << " alternate route(s) to " << rt.GetDestination ());
+  return true;
+}
+
+bool
+RoutingTable::PromoteAlternateRoute (Ipv4Address dst, Ipv4Address brokenNextHop, uint32_t minSeqNo,
+                                     RoutingTableEntry & rt)
+{
+  NS_LOG_FUNCTION (this << dst << brokenNextHop << minSeqNo);
+  std::map<Ipv4Address, std::vector<RoutingTableEntry> >::iterator a =
+    m_alternateEntry.find (dst);
+  std::map<Ipv4Address, RoutingTableEntry>::iterator primary =
+    m_ipv4AddressEntry.find (dst);
+  if (a == m_alternateEntry.end () || primary == m_ipv4AddressEntry.end ())
+    {
+      return false;
+    }
+  std::vector<RoutingTableEntry> & paths = a->second;
+  for (std::vector<RoutingTableEntry>::iterator j = paths.begin (); j != paths.end (); )
+    {
+      if (j->GetNextHop () == brokenNextHop)
+        {
+          j = paths.erase (j);
+          continue;
+        }
+      if (int32_t (j->GetSeqNo () - primary->second.GetSeqNo ()) < 0
+          || int32_t (j->GetSeqNo () - minSeqNo) < 0
+          || j->GetLifeTime () < Seconds (0)
+          || j->GetPathLet () < Seconds (0)
+          || !IsUsableNextHop (j->GetNextHop ()))
+        {
+          ++j;
+          continue;
+        }
+      rt = *j;
+      rt.SetFlag (VALID);
+      rt.SetRreqCnt (0);
+      // Upstream nodes keep using us, so the precursors belong to the destination
+      std::vector<Ipv4Address> precursors;
+      primary->second.GetPrecursors (precursors);
+      for (std::vector<Ipv4Address>::const_iterator p = precursors.begin (); p != precursors.end (); ++p)
+        {
+          rt.InsertPrecursor (*p);
+        }
+      paths.erase (j);
+      primary->second = rt;
+      if (paths.empty ())
+        {
+          m_alternateEntry.erase (a);
+        }
+      NS_LOG_LOGIC ("Route to " << dst << " switched to next hop " << rt.GetNextHop ());
+      return true;
+    }
+  if (paths.empty ())
+    {
+      m_alternateEntry.erase (a);
+    }
+  return false;
+}
+
+void
+RoutingTable::DeleteAlternateRoutesWithNextHop (Ipv4Address nextHop)
+{
+  NS_LOG_FUNCTION (this << nextHop);
+  for (std::map<Ipv4Address, std::vector<RoutingTableEntry> >::iterator a =
+         m_alternateEntry.begin (); a != m_alternateEntry.end (); )
+    {
+      std::vector<RoutingTableEntry> & paths = a->second;
+      for (std::vector<RoutingTableEntry>::iterator j = paths.begin (); j != paths.end (); )
+        {
+          if (j->GetNextHop () == nextHop)
+            {
+              j = paths.erase (j);
+            }
+          else
+            {
+              ++j;
+            }
+        }
+      if (paths.empty ())
+        {
+          std::map<Ipv4Address, std::vector<RoutingTableEntry> >::iterator tmp = a;
+          ++a;
+          m_alternateEntry.erase (tmp);
+        }
+      else
+        {
+          ++a;
+        }
+    }
+}
+
+uint32_t
+RoutingTable::GetAlternateRouteCount (Ipv4Address dst) const
+{
+  std::map<Ipv4Address, std::vector<RoutingTableEntry> >::const_iterator a =
+    m_alternateEntry.find (dst);
+  return (a == m_alternateEntry.end ()) ? 0 : a->second.size ();
+}
+
 void
 RoutingTable::Print (Ptr<OutputStreamWrapper> stream) const
 {
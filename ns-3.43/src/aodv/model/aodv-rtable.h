@@ -30,6 +30,7 @@
 
 #include <stdint.h>
 #include <cassert>
+#include <limits>
 #include <map>
 #include <vector>
 #include <sys/types.h>
@@ -39,6 +40,7 @@
 #include "ns3/net-device.h"
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/simulator.h"
+#include "ns3/vector.h"
 
 namespace ns3 {
 namespace aodv {
@@ -126,6 +128,21 @@ public:
   uint32_t GetEtx () const { return m_etx; }
   void SetEtx (uint32_t etx) { m_etx = etx; }
   // -----------------------------------------------------------------------
+  /// Minimum link expiration time along the path, counted from now
+  void SetPathLet (Time let) { m_pathLetExpire = let + Simulator::Now (); }
+  Time GetPathLet () const { return m_pathLetExpire - Simulator::Now (); }
+  /**
+   * Last known location of the destination, for location-aided discovery
+   * \param pos the position
+   * \param vel the velocity
+   * \param age time since the destination was at pos
+   */
+  void SetDstLocation (Vector pos, Vector vel, Time age);
+  bool HasDstLocation () const { return m_hasDstLocation; }
+  Vector GetDstPosition () const { return m_dstPosition; }
+  Vector GetDstVelocity () const { return m_dstVelocity; }
+  /// Time since the destination was at its last known position
+  Time GetDstLocationAge () const { return Simulator::Now () - m_dstLocationTime; }
 
   /// RREP_ACK timer
   Timer m_ackTimer;
@@ -153,6 +170,13 @@ private:
   
   // --- PERBAIKAN: Variabel diganti dari m_etx10000 menjadi m_etx ---
   uint32_t m_etx;
+  /// Absolute time at which the weakest link of the path is expected to break
+  Time m_pathLetExpire;
+  /// Last known location of the destination and the absolute time it was valid
+  bool m_hasDstLocation;
+  Vector m_dstPosition;
+  Vector m_dstVelocity;
+  Time m_dstLocationTime;
 };
 
 /**
@@ -177,15 +201,103 @@ public:
   void GetListOfDestinationWithNextHop (Ipv4Address nextHop, std::map<Ipv4Address, uint32_t> & unreachable);
   void InvalidateRoutesWithDst (std::map<Ipv4Address, uint32_t> const & unreachable);
   void DeleteAllRoutesFromInterface (Ipv4InterfaceAddress iface);
-  void Clear () { m_ipv4AddressEntry.clear (); }
+  void Clear () { m_ipv4AddressEntry.clear (); m_alternateEntry.clear (); InvalidateRouteCache (); }
   void Purge ();
   bool MarkLinkAsUnidirectional (Ipv4Address neighbor, Time blacklistTimeout);
   void Print (Ptr<OutputStreamWrapper> stream) const;
+  /// Read-only access to all primary entries, without purging
+  std::map<Ipv4Address, RoutingTableEntry> const & GetEntries () const { return m_ipv4AddressEntry; }
+
+  ///\name Data packet fast path
+  //\{
+  /**
+   * Extend the lifetime of a valid, unexpired route in place, without purging
+   * the table or copying the entry.
+   * \param dst the destination
+   * \param lifetime minimum remaining lifetime after the call
+   * \return true if the route is valid
+   */
+  bool RefreshLifeTime (Ipv4Address dst, Time lifetime);
+  /**
+   * Look up a valid route through the route cache and keep it and the route to its
+   * next hop alive. The lifetimes are extended at most once per refresh granularity,
+   * by lifetime plus the granularity, so a route never expires earlier than with a
+   * refresh on every packet. No purge, no entry copy, no allocation.
+   * \param dst the destination
+   * \param lifetime minimum remaining lifetime of both routes
+   * \param [out] refreshed true if the lifetimes were extended by this call
+   * \return the route, or 0 if there is no usable route in the cache or the table
+   */
+  Ptr<Ipv4Route> LookupValidRouteCached (Ipv4Address dst, Time lifetime, bool & refreshed);
+  /**
+   * \param dst the destination
+   * \returns the primary entry for dst, valid until GetGeneration changes, or 0
+   */
+  RoutingTableEntry * FindEntry (Ipv4Address dst);
+  /// \returns the generation, incremented whenever an entry is erased
+  uint32_t GetGeneration () const { return m_generation; }
+  /// Set the number of route cache slots, 0 disables the cache
+  void SetRouteCacheSize (uint32_t size);
+  uint32_t GetRouteCacheSize () const { return m_routeCache.size (); }
+  void SetRefreshGranularity (Time t) { m_refreshGranularity = t; }
+  Time GetRefreshGranularity () const { return m_refreshGranularity; }
+  //\}
+
+  ///\name Alternate routes (multipath mode)
+  //\{
+  /**
+   * Keep rt as an alternate to the primary route towards the same destination.
+   * Only routes with a fresher sequence number than the primary, or with the
+   * primary's sequence number and no more hops, and a next hop not used by any
+   * other path are accepted, so switching to an alternate can never form a loop.
+   * \param rt the candidate route
+   * \param maxPaths maximum number of paths per destination, primary included
+   * \return true if the route was stored
+   */
+  bool AddAlternateRoute (RoutingTableEntry const & rt, uint32_t maxPaths);
+  /**
+   * Replace the primary route to dst by its best usable alternate.
+   * \param dst the destination
+   * \param brokenNextHop next hop that must not be used by the new primary
+   * \param minSeqNo alternates with an older sequence number are not used
+   * \param rt the new primary route, on success
+   * \return true if an alternate was promoted
+   */
+  bool PromoteAlternateRoute (Ipv4Address dst, Ipv4Address brokenNextHop, uint32_t minSeqNo,
+                              RoutingTableEntry & rt);
+  /// Forget every alternate route going through nextHop
+  void DeleteAlternateRoutesWithNextHop (Ipv4Address nextHop);
+  /// \return the number of alternate routes stored for dst
+  uint32_t GetAlternateRouteCount (Ipv4Address dst) const;
+  //\}
 
 private:
   std::map<Ipv4Address, RoutingTableEntry> m_ipv4AddressEntry;
+  /// Alternate routes per destination, best first
+  std::map<Ipv4Address, std::vector<RoutingTableEntry> > m_alternateEntry;
   Time m_badLinkLifetime;
+
+  /// One route cache slot; the pointers stay valid until an entry is erased
+  struct RouteCacheSlot
+  {
+    Ipv4Address m_dst;                   ///< Cached destination
+    RoutingTableEntry * m_entry;         ///< Route to m_dst
+    RoutingTableEntry * m_nextHopEntry;  ///< Route to the next hop of m_entry
+    uint32_t m_generation;               ///< Table generation the pointers belong to
+    Time m_nextRefresh;                  ///< Lifetimes are not extended again before this time
+  };
+  /// Direct mapped route cache, indexed by destination hash
+  std::vector<RouteCacheSlot> m_routeCache;
+  /// Incremented whenever an entry is erased, which invalidates all cache slots
+  uint32_t m_generation;
+  /// Minimum time between two lifetime refreshes of a cached route
+  Time m_refreshGranularity;
+  /// An entry was erased: drop all cached pointers
+  void InvalidateRouteCache () { m_generation++; }
+
   void Purge (std::map<Ipv4Address, RoutingTableEntry> &table) const;
+  bool IsUsableNextHop (Ipv4Address nextHop) const;
+  static bool IsBetterPath (RoutingTableEntry const & a, RoutingTableEntry const & b);
 };
 
 }  // namespace aodv
@@ -0,0 +1,275 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "aodv-snapshot.h"
+#include "aodv-routing-protocol.h"
+#include "aodv-neighbor-store.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include <cstring>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AodvSnapshot");
+
+namespace aodv {
+
+static_assert (sizeof (SnapshotFileHeader) == 32, "Unexpected snapshot file header size");
+static_assert (sizeof (SnapshotBlockHeader) == 24, "Unexpected snapshot block header size");
+static_assert (sizeof (SnapshotRouteRecord) == 40, "Unexpected snapshot route record size");
+static_assert (sizeof (SnapshotNeighborRecord) == 40, "Unexpected snapshot neighbor record size");
+
+NS_OBJECT_ENSURE_REGISTERED (SnapshotWriter);
+
+TypeId
+SnapshotWriter::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::aodv::SnapshotWriter")
+    .SetParent<Object> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<SnapshotWriter> ()
+    .AddAttribute ("FileName", "Name of the binary snapshot file.",
+                   StringValue ("aodv.snap"),
+                   MakeStringAccessor (&SnapshotWriter::m_fileName),
+                   MakeStringChecker ())
+    .AddAttribute ("Interval", "Time between two snapshots.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&SnapshotWriter::m_interval),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+SnapshotWriter::SnapshotWriter ()
+  : m_interval (Seconds (1)),
+    m_timer (Timer::CANCEL_ON_DESTROY)
+{
+}
+
+SnapshotWriter::~SnapshotWriter ()
+{
+}
+
+void
+SnapshotWriter::DoDispose ()
+{
+  Stop ();
+  Object::DoDispose ();
+}
+
+bool
+SnapshotWriter::Open ()
+{
+  NS_LOG_FUNCTION (this << m_fileName);
+  if (m_file.is_open ())
+    {
+      return true;
+    }
+  if (m_createdFile == m_fileName)
+    {
+      // Reopened after Stop (), the snapshots already written are kept
+      if (!CheckFileHeader ())
+        {
+          NS_LOG_ERROR ("Snapshot file " << m_fileName << " has another format, not appending to it");
+          return false;
+        }
+      m_file.open (m_fileName.c_str (), std::ios::out | std::ios::binary | std::ios::app);
+      if (!m_file.is_open ())
+        {
+          NS_LOG_ERROR ("Cannot open snapshot file " << m_fileName);
+          return false;
+        }
+      return m_file.good ();
+    }
+  m_file.open (m_fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open ())
+    {
+      NS_LOG_ERROR ("Cannot open snapshot file " << m_fileName);
+      return false;
+    }
+  m_createdFile = m_fileName;
+  SnapshotFileHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, "AODVSNAP", sizeof (header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.byteOrder = 0x01020304;
+  header.blockHeaderSize = sizeof (SnapshotBlockHeader);
+  header.routeRecordSize = sizeof (SnapshotRouteRecord);
+  header.neighborRecordSize = sizeof (SnapshotNeighborRecord);
+  m_file.write (reinterpret_cast<const char *> (&header), sizeof (header));
+  return m_file.good ();
+}
+
+bool
+SnapshotWriter::CheckFileHeader () const
+{
+  std::ifstream in (m_fileName.c_str (), std::ios::in | std::ios::binary);
+  SnapshotFileHeader header;
+  if (!in.read (reinterpret_cast<char *> (&header), sizeof (header)))
+    {
+      return false;
+    }
+  return (std::memcmp (header.magic, "AODVSNAP", sizeof (header.magic)) == 0
+          && header.version == SNAPSHOT_VERSION
+          && header.byteOrder == 0x01020304
+          && header.blockHeaderSize == sizeof (SnapshotBlockHeader)
+          && header.routeRecordSize == sizeof (SnapshotRouteRecord)
+          && header.neighborRecordSize == sizeof (SnapshotNeighborRecord));
+}
+
+void
+SnapshotWriter::Start (Time start)
+{
+  NS_LOG_FUNCTION (this << start);
+  NS_ABORT_MSG_UNLESS (m_interval.IsStrictlyPositive (), "Snapshot interval must be positive");
+  if (!Open ())
+    {
+      return;
+    }
+  m_timer.SetFunction (&SnapshotWriter::SnapshotTimerExpire, this);
+  m_timer.Remove ();
+  m_timer.Schedule (start);
+}
+
+void
+SnapshotWriter::Stop ()
+{
+  NS_LOG_FUNCTION (this);
+  m_timer.Cancel ();
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+}
+
+void
+SnapshotWriter::SnapshotTimerExpire ()
+{
+  WriteSnapshot ();
+  m_timer.Schedule (m_interval);
+}
+
+/// Clamp a duration to milliseconds that fit in a record field
+static int32_t
+ClampMs (Time t)
+{
+  int64_t ms = t.GetMilliSeconds ();
+  if (ms > std::numeric_limits<int32_t>::max ())
+    {
+      return std::numeric_limits<int32_t>::max ();
+    }
+  if (ms < std::numeric_limits<int32_t>::min ())
+    {
+      return std::numeric_limits<int32_t>::min ();
+    }
+  return int32_t (ms);
+}
+
+void
+SnapshotWriter::WriteSnapshot ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!Open ())
+    {
+      return;
+    }
+  m_routes.clear ();
+  m_neighbors.clear ();
+  SnapshotBlockHeader block;
+  std::memset (&block, 0, sizeof (block));
+  block.timeNs = Simulator::Now ().GetNanoSeconds ();
+
+  for (NodeList::Iterator n = NodeList::Begin (); n != NodeList::End (); ++n)
+    {
+      Ptr<RoutingProtocol> aodv = (*n)->GetObject<RoutingProtocol> ();
+      if (aodv == nullptr)
+        {
+          continue;
+        }
+      uint32_t nodeId = (*n)->GetId ();
+      block.nodeCount++;
+
+      std::map<Ipv4Address, RoutingTableEntry> const & entries = aodv->GetRoutingTable ().GetEntries ();
+      for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = entries.begin (); i != entries.end (); ++i)
+        {
+          RoutingTableEntry const & rt = i->second;
+          SnapshotRouteRecord r;
+          std::memset (&r, 0, sizeof (r));
+          r.nodeId = nodeId;
+          r.destination = i->first.Get ();
+          r.nextHop = rt.GetNextHop ().Get ();
+          r.interface = rt.GetInterface ().GetLocal ().Get ();
+          r.seqNo = rt.GetSeqNo ();
+          r.etx = rt.GetEtx ();
+          r.lifetimeMs = ClampMs (rt.GetLifeTime ());
+          r.pathLetMs = ClampMs (rt.GetPathLet ());
+          r.hops = rt.GetHop ();
+          r.flag = uint8_t (rt.GetFlag ());
+          r.validSeqNo = rt.GetValidSeqNo () ? 1 : 0;
+          m_routes.push_back (r);
+        }
+
+      NeighborEtx const & nbEtx = aodv->GetNeighborEtx ();
+      NeighborStore::Records const & neighbors = nbEtx.GetStore ().GetRecords ();
+      for (NeighborStore::Records::const_iterator i = neighbors.begin (); i != neighbors.end (); ++i)
+        {
+          if (!i->second.m_hasEtx)
+            {
+              continue;
+            }
+          NeighborEtx::Etx const & etx = i->second.m_etx;
+          SnapshotNeighborRecord r;
+          std::memset (&r, 0, sizeof (r));
+          r.nodeId = nodeId;
+          r.neighbor = i->first.Get ();
+          r.etx = nbEtx.GetEtx (etx);
+          NeighborEtx::Link const * link = nbEtx.GetBestLink (etx);
+          if (link != 0)
+            {
+              r.lppBitmap = link->m_lppMyCnt10bMap;
+              r.lppReverse = link->m_lppReverse;
+            }
+          r.position[0] = float (etx.m_position.x);
+          r.position[1] = float (etx.m_position.y);
+          r.position[2] = float (etx.m_position.z);
+          r.velocity[0] = float (etx.m_velocity.x);
+          r.velocity[1] = float (etx.m_velocity.y);
+          r.velocity[2] = float (etx.m_velocity.z);
+          m_neighbors.push_back (r);
+        }
+    }
+
+  block.routeCount = m_routes.size ();
+  block.neighborCount = m_neighbors.size ();
+  m_file.write (reinterpret_cast<const char *> (&block), sizeof (block));
+  if (!m_routes.empty ())
+    {
+      m_file.write (reinterpret_cast<const char *> (&m_routes[0]), m_routes.size () * sizeof (SnapshotRouteRecord));
+    }
+  if (!m_neighbors.empty ())
+    {
+      m_file.write (reinterpret_cast<const char *> (&m_neighbors[0]), m_neighbors.size () * sizeof (SnapshotNeighborRecord));
+    }
+  m_file.flush ();
+  NS_LOG_LOGIC ("Snapshot of " << block.nodeCount << " nodes: " << block.routeCount << " routes, "
+                               << block.neighborCount << " neighbors");
+}
+
+}  // namespace aodv
+}  // namespace ns3
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AODVSNAPSHOT_H
+#define AODVSNAPSHOT_H
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/timer.h"
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv
+ * \brief Binary snapshot file layout
+ *
+ * A snapshot file starts with one SnapshotFileHeader, followed by any number of
+ * snapshots. Each snapshot is a SnapshotBlockHeader followed by routeCount
+ * SnapshotRouteRecord and neighborCount SnapshotNeighborRecord. All records have
+ * a fixed size and natural alignment, and are written in host byte order
+ * (see SnapshotFileHeader::byteOrder), so the file can be memory mapped and
+ * walked without parsing. The file is only ever appended to.
+ */
+struct SnapshotFileHeader
+{
+  char magic[8];              ///< "AODVSNAP"
+  uint32_t version;           ///< Format version, SNAPSHOT_VERSION
+  uint32_t byteOrder;         ///< 0x01020304 written in host byte order
+  uint32_t blockHeaderSize;   ///< sizeof (SnapshotBlockHeader)
+  uint32_t routeRecordSize;   ///< sizeof (SnapshotRouteRecord)
+  uint32_t neighborRecordSize; ///< sizeof (SnapshotNeighborRecord)
+  uint32_t reserved;
+};
+
+/// Header of one snapshot
+struct SnapshotBlockHeader
+{
+  int64_t timeNs;             ///< Simulation time of the snapshot
+  uint32_t nodeCount;         ///< Number of nodes running AODV
+  uint32_t routeCount;        ///< Number of SnapshotRouteRecord that follow
+  uint32_t neighborCount;     ///< Number of SnapshotNeighborRecord after the routes
+  uint32_t reserved;
+};
+
+/// One routing table entry of one node
+struct SnapshotRouteRecord
+{
+  uint32_t nodeId;
+  uint32_t destination;       ///< IPv4 address in host order
+  uint32_t nextHop;
+  uint32_t interface;         ///< Local address of the outgoing interface
+  uint32_t seqNo;
+  uint32_t etx;               ///< Accumulated hybrid metric
+  int32_t lifetimeMs;         ///< Remaining lifetime, negative if expired
+  int32_t pathLetMs;          ///< Remaining path LET, INT32_MAX if unbounded
+  uint16_t hops;
+  uint8_t flag;               ///< RouteFlags
+  uint8_t validSeqNo;
+  uint32_t reserved;
+};
+
+/// NeighborEtx state of one neighbor of one node
+struct SnapshotNeighborRecord
+{
+  uint32_t nodeId;
+  uint32_t neighbor;          ///< IPv4 address in host order
+  uint32_t etx;               ///< Link ETX, EtxMaxValue if unknown
+  uint16_t lppBitmap;         ///< Received LPP bitmap (12 time stamps) of the best link
+  uint8_t lppReverse;         ///< LPP count reported by the neighbor on the best link
+  uint8_t reserved;
+  float position[3];
+  float velocity[3];
+};
+
+/// Snapshot format version
+const uint32_t SNAPSHOT_VERSION = 1;
+
+/**
+ * \ingroup aodv
+ * \brief Periodically dumps the routing table and NeighborEtx state of all AODV nodes
+ *
+ * Much cheaper than RoutingProtocol::PrintRoutingTable: no table copy, no purge,
+ * no text formatting. Records of all nodes are collected into reusable buffers
+ * and appended to the file with one write per snapshot.
+ *
+ * \code
+ *   Ptr<aodv::SnapshotWriter> snap = CreateObject<aodv::SnapshotWriter> ();
+ *   snap->SetAttribute ("FileName", StringValue ("run.snap"));
+ *   snap->SetAttribute ("Interval", TimeValue (Seconds (1)));
+ *   snap->Start (Seconds (1));
+ * \endcode
+ */
+class SnapshotWriter : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  SnapshotWriter ();
+  virtual ~SnapshotWriter ();
+
+  /**
+   * Open the file and take a snapshot every Interval, the first one at start.
+   * \param start delay before the first snapshot
+   */
+  void Start (Time start);
+  /// Stop taking snapshots and close the file
+  void Stop ();
+  /// Append a snapshot of all nodes now
+  void WriteSnapshot ();
+
+protected:
+  virtual void DoDispose ();
+
+private:
+  /**
+   * Open the file. The first time the file is truncated and the file header
+   * written; reopened after Stop () the snapshots are appended, once the
+   * existing file header is found to match this format.
+   * \return true if the file is ready for snapshots
+   */
+  bool Open ();
+  /**
+   * Check the file header of an existing snapshot file
+   * \return true if snapshots of this format can be appended to it
+   */
+  bool CheckFileHeader () const;
+  /// Timer handler
+  void SnapshotTimerExpire ();
+
+  /// Output file name
+  std::string m_fileName;
+  /// File created by this writer, empty until the first Open
+  std::string m_createdFile;
+  /// Time between snapshots
+  Time m_interval;
+  /// Output file
+  std::ofstream m_file;
+  /// Snapshot timer
+  Timer m_timer;
+  /// Reused record buffers
+  std::vector<SnapshotRouteRecord> m_routes;
+  std::vector<SnapshotNeighborRecord> m_neighbors;
+};
+
+}  // namespace aodv
+}  // namespace ns3
+
+#endif /* AODVSNAPSHOT_H */
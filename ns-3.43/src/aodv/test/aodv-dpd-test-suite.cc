@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/aodv-dpd.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Rotation and expiry of the rotating Bloom filter
+ */
+class RotatingBloomFilterTestCase : public TestCase
+{
+public:
+  RotatingBloomFilterTestCase ();
+  virtual void DoRun ();
+
+private:
+  /// Keys inserted at 0 s are still known after one rotation
+  void CheckAfterOneRotation ();
+  /// Keys of the previous filter are forgotten at the next rotation
+  void CheckAfterTwoRotations ();
+  /// Keys are forgotten after an idle gap of more than two lifetimes
+  void CheckAfterIdleGap ();
+
+  /// Filter under test, lifetime 1 s
+  RotatingBloomFilter m_filter;
+  /// Filter for the idle gap check, lifetime 1 s
+  RotatingBloomFilter m_idle;
+};
+
+RotatingBloomFilterTestCase::RotatingBloomFilterTestCase ()
+  : TestCase ("Rotating Bloom filter"),
+    m_filter (4096, 0.001, Seconds (1)),
+    m_idle (4096, 0.001, Seconds (1))
+{
+}
+
+void
+RotatingBloomFilterTestCase::DoRun ()
+{
+  NS_TEST_EXPECT_MSG_EQ (m_filter.IsDuplicate (1), false, "New key");
+  NS_TEST_EXPECT_MSG_EQ (m_filter.IsDuplicate (1), true, "Known key");
+  NS_TEST_EXPECT_MSG_EQ (m_filter.IsDuplicate (2), false, "New key");
+  NS_TEST_EXPECT_MSG_EQ (m_idle.IsDuplicate (1), false, "New key");
+
+  Simulator::Schedule (Seconds (1.5), &RotatingBloomFilterTestCase::CheckAfterOneRotation, this);
+  Simulator::Schedule (Seconds (2.5), &RotatingBloomFilterTestCase::CheckAfterTwoRotations, this);
+  Simulator::Schedule (Seconds (2.5), &RotatingBloomFilterTestCase::CheckAfterIdleGap, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+RotatingBloomFilterTestCase::CheckAfterOneRotation ()
+{
+  // Rotated at 1.5 s, key 1 now lives in the previous filter
+  NS_TEST_EXPECT_MSG_EQ (m_filter.IsDuplicate (1), true, "Key of the previous filter");
+  NS_TEST_EXPECT_MSG_EQ (m_filter.IsDuplicate (3), false, "New key");
+}
+
+void
+RotatingBloomFilterTestCase::CheckAfterTwoRotations ()
+{
+  // Rotated again at 2.5 s: key 3 moves to the previous filter, key 2 is gone
+  NS_TEST_EXPECT_MSG_EQ (m_filter.IsDuplicate (3), true, "Key of the previous filter");
+  NS_TEST_EXPECT_MSG_EQ (m_filter.IsDuplicate (2), false, "Key older than two lifetimes");
+}
+
+void
+RotatingBloomFilterTestCase::CheckAfterIdleGap ()
+{
+  // No lookup since 0 s: both filters are cleared
+  NS_TEST_EXPECT_MSG_EQ (m_idle.IsDuplicate (1), false, "Key older than two lifetimes");
+  NS_TEST_EXPECT_MSG_EQ (m_idle.IsDuplicate (1), true, "Known key");
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Lookup counters of duplicate packet detection in both modes
+ */
+class DpdCountersTestCase : public TestCase
+{
+public:
+  DpdCountersTestCase ();
+  virtual void DoRun ();
+};
+
+DpdCountersTestCase::DpdCountersTestCase ()
+  : TestCase ("Duplicate packet detection counters")
+{
+}
+
+void
+DpdCountersTestCase::DoRun ()
+{
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.0.0.1"));
+  Ptr<Packet> p1 = Create<Packet> ();
+  Ptr<Packet> p2 = Create<Packet> ();
+
+  DuplicatePacketDetection exact (Seconds (1));
+  NS_TEST_EXPECT_MSG_EQ (exact.IsDuplicate (p1, header), false, "New packet");
+  NS_TEST_EXPECT_MSG_EQ (exact.IsDuplicate (p1, header), true, "Known packet");
+  NS_TEST_EXPECT_MSG_EQ (exact.IsDuplicate (p2, header), false, "New packet");
+  NS_TEST_EXPECT_MSG_EQ (exact.GetLookups (), 3u, "Lookups of the exact cache");
+  NS_TEST_EXPECT_MSG_EQ (exact.GetPositives (), 1u, "Duplicates of the exact cache");
+  NS_TEST_EXPECT_MSG_EQ (exact.GetEarlyRotations (), 0u, "No rotation in exact mode");
+
+  DuplicatePacketDetection bloom (Seconds (1));
+  bloom.SetMemoryBudget (4096, 0.001);
+  NS_TEST_EXPECT_MSG_EQ (bloom.IsDuplicate (p1, header), false, "New packet");
+  NS_TEST_EXPECT_MSG_EQ (bloom.IsDuplicate (p1, header), true, "Known packet");
+  NS_TEST_EXPECT_MSG_EQ (bloom.GetLookups (), 2u, "Lookups of the Bloom filter");
+  NS_TEST_EXPECT_MSG_EQ (bloom.GetPositives (), 1u, "Duplicates of the Bloom filter");
+
+  bloom.SetMemoryBudget (0, 0.001);
+  NS_TEST_EXPECT_MSG_EQ ((bloom.GetFilter () == nullptr), true, "Back to the exact cache");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Duplicate packet detection test suite
+ */
+class AodvDpdTestSuite : public TestSuite
+{
+public:
+  AodvDpdTestSuite ()
+    : TestSuite ("routing-aodv-dpd", Type::UNIT)
+  {
+    AddTestCase (new RotatingBloomFilterTestCase, TestCase::Duration::QUICK);
+    AddTestCase (new DpdCountersTestCase, TestCase::Duration::QUICK);
+  }
+} g_aodvDpdTestSuite; ///< the test suite
+
+}  // namespace aodv
+}  // namespace ns3
@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/aodv-id-cache.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Expiry and refresh of IDs across the time buckets of IdCache
+ */
+class IdCacheTestCase : public TestCase
+{
+public:
+  IdCacheTestCase ();
+  virtual void DoRun ();
+
+private:
+  /// IDs are known until their lifetime is over
+  void CheckBeforeExpiry ();
+  /// An expired ID whose bucket is not purged yet is added again
+  void CheckRefresh ();
+  /// Purging the first bucket keeps the refreshed ID
+  void CheckFirstBucketPurged ();
+  /// All IDs are forgotten after their lifetime
+  void CheckAllExpired ();
+
+  /// Cache under test, lifetime 10 s, buckets 1.25 s wide
+  IdCache m_cache;
+};
+
+IdCacheTestCase::IdCacheTestCase ()
+  : TestCase ("Id Cache"),
+    m_cache (Seconds (10))
+{
+}
+
+void
+IdCacheTestCase::DoRun ()
+{
+  // Ids added until 1.25 s share the first bucket, which expires at 11 s
+  NS_TEST_EXPECT_MSG_EQ (m_cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 1), false, "New id");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 1), true, "Known id");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.IsDuplicate (Ipv4Address ("4.3.2.1"), 1), false, "Same id, other address");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.GetSize (), 2u, "Two ids");
+
+  Simulator::Schedule (Seconds (1), &IdCacheTestCase::CheckBeforeExpiry, this);
+  Simulator::Schedule (Seconds (10.5), &IdCacheTestCase::CheckRefresh, this);
+  Simulator::Schedule (Seconds (11.5), &IdCacheTestCase::CheckFirstBucketPurged, this);
+  Simulator::Schedule (Seconds (21), &IdCacheTestCase::CheckAllExpired, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+IdCacheTestCase::CheckBeforeExpiry ()
+{
+  NS_TEST_EXPECT_MSG_EQ (m_cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 2), false, "New id");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 3), false, "New id");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.GetSize (), 4u, "Four ids");
+}
+
+void
+IdCacheTestCase::CheckRefresh ()
+{
+  // Ids 1 have expired at 10 s, the first bucket lasts until 11 s
+  NS_TEST_EXPECT_MSG_EQ (m_cache.GetSize (), 2u, "Ids added at 1 s");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 1), false, "Expired id");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 1), true, "Refreshed id");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.GetSize (), 3u, "Refreshed id counted");
+}
+
+void
+IdCacheTestCase::CheckFirstBucketPurged ()
+{
+  NS_TEST_EXPECT_MSG_EQ (m_cache.GetSize (), 1u, "Only the refreshed id is left");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 1), true, "Refreshed id");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 2), false, "Expired id");
+}
+
+void
+IdCacheTestCase::CheckAllExpired ()
+{
+  NS_TEST_EXPECT_MSG_EQ (m_cache.GetSize (), 1u, "Id added again at 11.5 s");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 1), false, "Refreshed id expired");
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Id Cache test suite
+ */
+class IdCacheTestSuite : public TestSuite
+{
+public:
+  IdCacheTestSuite ()
+    : TestSuite ("routing-aodv-id-cache", Type::UNIT)
+  {
+    AddTestCase (new IdCacheTestCase, TestCase::Duration::QUICK);
+  }
+} g_idCacheTestSuite; ///< the test suite
+
+}  // namespace aodv
+}  // namespace ns3
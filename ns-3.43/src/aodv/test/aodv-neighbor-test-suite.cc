@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/aodv-neighbor.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Re-arming of the neighbor expiry timer
+ *
+ * Neighbors are only closed by the timer here: the checks never call a method that purges.
+ */
+class NeighborTimerTestCase : public TestCase
+{
+public:
+  NeighborTimerTestCase ();
+  virtual void DoRun ();
+
+private:
+  /**
+   * Link failure callback
+   * \param addr the neighbor whose link is closed
+   */
+  void LinkFailure (Ipv4Address addr);
+  /// Extend the first neighbor after the timer was armed for it
+  void ExtendFirst ();
+  /// The timer fired for the old expiry and closed nothing
+  void CheckNothingClosed ();
+  /// The re-armed timer closed the first neighbor at its new expiry
+  void CheckFirstClosed ();
+  /// The second neighbor is closed no earlier than the minimum purge interval
+  void CheckSecondClosed ();
+
+  /// Neighbors under test, timer driven purges at least 1 s apart
+  Neighbors m_nb;
+  /// Closed links and the time they were closed at
+  std::vector<std::pair<Ipv4Address, Time> > m_closed;
+};
+
+NeighborTimerTestCase::NeighborTimerTestCase ()
+  : TestCase ("Neighbor expiry timer"),
+    m_nb (Seconds (1))
+{
+}
+
+void
+NeighborTimerTestCase::LinkFailure (Ipv4Address addr)
+{
+  m_closed.push_back (std::make_pair (addr, Simulator::Now ()));
+}
+
+void
+NeighborTimerTestCase::DoRun ()
+{
+  m_nb.SetCallback (MakeCallback (&NeighborTimerTestCase::LinkFailure, this));
+  // The timer is armed for the first neighbor, at 1 s
+  m_nb.Update (Ipv4Address ("1.2.3.4"), Seconds (1));
+  m_nb.Update (Ipv4Address ("4.3.2.1"), Seconds (3));
+
+  Simulator::Schedule (Seconds (0.5), &NeighborTimerTestCase::ExtendFirst, this);
+  Simulator::Schedule (Seconds (2), &NeighborTimerTestCase::CheckNothingClosed, this);
+  Simulator::Schedule (Seconds (3), &NeighborTimerTestCase::CheckFirstClosed, this);
+  Simulator::Schedule (Seconds (4), &NeighborTimerTestCase::CheckSecondClosed, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+NeighborTimerTestCase::ExtendFirst ()
+{
+  // Now expires at 2.5 s; the timer still fires at 1 s and has to re-arm itself
+  m_nb.Update (Ipv4Address ("1.2.3.4"), Seconds (2));
+}
+
+void
+NeighborTimerTestCase::CheckNothingClosed ()
+{
+  NS_TEST_EXPECT_MSG_EQ (m_closed.size (), 0u, "Extended neighbor kept");
+}
+
+void
+NeighborTimerTestCase::CheckFirstClosed ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_closed.size (), 1u, "First neighbor closed");
+  NS_TEST_EXPECT_MSG_EQ (m_closed[0].first, Ipv4Address ("1.2.3.4"), "First neighbor closed");
+  NS_TEST_EXPECT_MSG_EQ ((m_closed[0].second > Seconds (2.5) && m_closed[0].second < Seconds (2.6)),
+                         true, "Closed just after its new expiry");
+}
+
+void
+NeighborTimerTestCase::CheckSecondClosed ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_closed.size (), 2u, "Second neighbor closed");
+  NS_TEST_EXPECT_MSG_EQ (m_closed[1].first, Ipv4Address ("4.3.2.1"), "Second neighbor closed");
+  // Expired at 3 s, held back until 1 s after the purge at 2.5 s
+  NS_TEST_EXPECT_MSG_EQ ((m_closed[1].second > Seconds (3.5) && m_closed[1].second < Seconds (3.6)),
+                         true, "Closed at the next allowed purge");
+  NS_TEST_EXPECT_MSG_EQ (m_nb.IsNeighbor (Ipv4Address ("1.2.3.4")), false, "No neighbor left");
+  NS_TEST_EXPECT_MSG_EQ (m_nb.IsNeighbor (Ipv4Address ("4.3.2.1")), false, "No neighbor left");
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Neighbors test suite
+ */
+class NeighborTestSuite : public TestSuite
+{
+public:
+  NeighborTestSuite ()
+    : TestSuite ("routing-aodv-neighbor", Type::UNIT)
+  {
+    AddTestCase (new NeighborTimerTestCase, TestCase::Duration::QUICK);
+  }
+} g_neighborTestSuite; ///< the test suite
+
+}  // namespace aodv
+}  // namespace ns3
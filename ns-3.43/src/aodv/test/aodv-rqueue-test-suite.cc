@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/aodv-rqueue.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include <vector>
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Per destination FIFO order, eviction and timer driven purge of RequestQueue
+ */
+class RequestQueueTestCase : public TestCase
+{
+public:
+  RequestQueueTestCase ();
+  virtual void DoRun ();
+
+private:
+  /**
+   * Make a queue entry whose drop is recorded in m_dropped
+   * \param dst the destination of the packet
+   * \returns the entry
+   */
+  QueueEntry MakeEntry (Ipv4Address dst);
+  /**
+   * Error callback of the queued packets
+   * \param p the dropped packet
+   * \param header the IPv4 header of the packet
+   * \param err the error
+   */
+  void Drop (Ptr<const Packet> p, const Ipv4Header & header, Socket::SocketErrno err);
+  /// Enqueue a second packet while the first one waits for its timeout
+  void EnqueueLater ();
+  /// The first packet is dropped by the purge timer
+  void CheckFirstTimeout ();
+  /// The second packet is dropped by the re-armed purge timer
+  void CheckSecondTimeout ();
+
+  /// Queue under test, three packets, 10 s timeout
+  RequestQueue m_queue;
+  /// Uids of the dropped packets, in drop order
+  std::vector<uint64_t> m_dropped;
+  /// Uid of the packet queued at 0 s
+  uint64_t m_first;
+  /// Uid of the packet queued at 5 s
+  uint64_t m_second;
+};
+
+RequestQueueTestCase::RequestQueueTestCase ()
+  : TestCase ("Request queue"),
+    m_queue (3, Seconds (10)),
+    m_first (0),
+    m_second (0)
+{
+}
+
+QueueEntry
+RequestQueueTestCase::MakeEntry (Ipv4Address dst)
+{
+  Ipv4Header h;
+  h.SetDestination (dst);
+  return QueueEntry (Create<Packet> (), h, QueueEntry::UnicastForwardCallback (),
+                     MakeCallback (&RequestQueueTestCase::Drop, this));
+}
+
+void
+RequestQueueTestCase::Drop (Ptr<const Packet> p, const Ipv4Header & header, Socket::SocketErrno err)
+{
+  m_dropped.push_back (p->GetUid ());
+}
+
+void
+RequestQueueTestCase::DoRun ()
+{
+  Ipv4Address d1 ("1.2.3.4");
+  Ipv4Address d2 ("4.3.2.1");
+  QueueEntry e1 = MakeEntry (d1);
+  QueueEntry e2 = MakeEntry (d2);
+  QueueEntry e3 = MakeEntry (d1);
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Enqueue (e1), true, "Enqueue");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Enqueue (e2), true, "Enqueue");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Enqueue (e3), true, "Enqueue");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Enqueue (e1), false, "Same packet and destination");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.GetSize (), 3u, "Three packets");
+
+  // Packets of one destination leave in arrival order, whatever is queued in between
+  QueueEntry e;
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Dequeue (d1, e), true, "Dequeue");
+  NS_TEST_EXPECT_MSG_EQ (e.GetPacket ()->GetUid (), e1.GetPacket ()->GetUid (), "Oldest packet of d1");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Dequeue (d1, e), true, "Dequeue");
+  NS_TEST_EXPECT_MSG_EQ (e.GetPacket ()->GetUid (), e3.GetPacket ()->GetUid (), "Next packet of d1");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Dequeue (d1, e), false, "No packet of d1 left");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Find (d1), false, "No packet of d1 left");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Find (d2), true, "Packet of d2");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.GetSize (), 1u, "One packet");
+
+  // A full queue evicts its oldest packet, whatever the destination
+  QueueEntry e4 = MakeEntry (d1);
+  QueueEntry e5 = MakeEntry (d1);
+  QueueEntry e6 = MakeEntry (d2);
+  m_queue.Enqueue (e4);
+  m_queue.Enqueue (e5);
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Enqueue (e6), true, "Enqueue in a full queue");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.GetSize (), 3u, "Queue stays full");
+  NS_TEST_ASSERT_MSG_EQ (m_dropped.size (), 1u, "One packet evicted");
+  NS_TEST_EXPECT_MSG_EQ (m_dropped.back (), e2.GetPacket ()->GetUid (), "Oldest packet evicted");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Dequeue (d2, e), true, "Dequeue");
+  NS_TEST_EXPECT_MSG_EQ (e.GetPacket ()->GetUid (), e6.GetPacket ()->GetUid (), "Packet of d2 after eviction");
+
+  m_queue.DropPacketWithDst (d1);
+  NS_TEST_ASSERT_MSG_EQ (m_dropped.size (), 3u, "Packets of d1 dropped");
+  NS_TEST_EXPECT_MSG_EQ (m_dropped[1], e4.GetPacket ()->GetUid (), "Packets of d1 dropped in order");
+  NS_TEST_EXPECT_MSG_EQ (m_dropped[2], e5.GetPacket ()->GetUid (), "Packets of d1 dropped in order");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.GetSize (), 0u, "Empty queue");
+
+  // Expired packets are dropped by the purge timer, without any call on the queue
+  m_dropped.clear ();
+  QueueEntry e7 = MakeEntry (d1);
+  m_queue.Enqueue (e7);
+  m_first = e7.GetPacket ()->GetUid ();
+  Simulator::Schedule (Seconds (5), &RequestQueueTestCase::EnqueueLater, this);
+  Simulator::Schedule (Seconds (10.5), &RequestQueueTestCase::CheckFirstTimeout, this);
+  Simulator::Schedule (Seconds (15.5), &RequestQueueTestCase::CheckSecondTimeout, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+RequestQueueTestCase::EnqueueLater ()
+{
+  NS_TEST_EXPECT_MSG_EQ (m_dropped.size (), 0u, "Nothing expired yet");
+  QueueEntry e = MakeEntry (Ipv4Address ("4.3.2.1"));
+  m_queue.Enqueue (e);
+  m_second = e.GetPacket ()->GetUid ();
+}
+
+void
+RequestQueueTestCase::CheckFirstTimeout ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_dropped.size (), 1u, "First packet expired");
+  NS_TEST_EXPECT_MSG_EQ (m_dropped.back (), m_first, "First packet expired");
+}
+
+void
+RequestQueueTestCase::CheckSecondTimeout ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_dropped.size (), 2u, "Second packet expired");
+  NS_TEST_EXPECT_MSG_EQ (m_dropped.back (), m_second, "Second packet expired");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.GetSize (), 0u, "Empty queue");
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Request queue test suite
+ */
+class RequestQueueTestSuite : public TestSuite
+{
+public:
+  RequestQueueTestSuite ()
+    : TestSuite ("routing-aodv-rqueue", Type::UNIT)
+  {
+    AddTestCase (new RequestQueueTestCase, TestCase::Duration::QUICK);
+  }
+} g_requestQueueTestSuite; ///< the test suite
+
+}  // namespace aodv
+}  // namespace ns3
@@ -0,0 +1,148 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Converts a binary snapshot written by aodv::SnapshotWriter to two CSV files:
+//   <out>-routes.csv     one line per routing table entry per node per snapshot
+//   <out>-neighbors.csv  one line per NeighborEtx entry per node per snapshot
+//
+// ./ns3 run "aodv-snapshot-to-csv --in=run.snap --out=run"
+
+#include "ns3/core-module.h"
+#include "ns3/aodv-snapshot.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+using namespace ns3::aodv;
+
+static std::string
+AddressToString (uint32_t a)
+{
+  std::ostringstream os;
+  os << ((a >> 24) & 0xff) << "." << ((a >> 16) & 0xff) << "."
+     << ((a >> 8) & 0xff) << "." << (a & 0xff);
+  return os.str ();
+}
+
+static const char *
+FlagToString (uint8_t flag)
+{
+  switch (flag)
+    {
+    case 0:
+      return "UP";
+    case 1:
+      return "DOWN";
+    case 2:
+      return "IN_SEARCH";
+    default:
+      return "?";
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string in ("aodv.snap");
+  std::string out;
+
+  CommandLine cmd;
+  cmd.AddValue ("in", "Binary snapshot file", in);
+  cmd.AddValue ("out", "Prefix of the CSV files, default is the input name", out);
+  cmd.Parse (argc, argv);
+  if (out.empty ())
+    {
+      out = in;
+    }
+
+  std::ifstream file (in.c_str (), std::ios::in | std::ios::binary);
+  if (!file.is_open ())
+    {
+      std::cerr << "Cannot open " << in << std::endl;
+      return 1;
+    }
+
+  SnapshotFileHeader header;
+  if (!file.read (reinterpret_cast<char *> (&header), sizeof (header))
+      || std::memcmp (header.magic, "AODVSNAP", sizeof (header.magic)) != 0)
+    {
+      std::cerr << in << " is not an AODV snapshot file" << std::endl;
+      return 1;
+    }
+  if (header.byteOrder != 0x01020304)
+    {
+      std::cerr << in << " was written on a host with a different byte order" << std::endl;
+      return 1;
+    }
+  if (header.version != SNAPSHOT_VERSION
+      || header.blockHeaderSize != sizeof (SnapshotBlockHeader)
+      || header.routeRecordSize != sizeof (SnapshotRouteRecord)
+      || header.neighborRecordSize != sizeof (SnapshotNeighborRecord))
+    {
+      std::cerr << in << " has unsupported snapshot version " << header.version << std::endl;
+      return 1;
+    }
+
+  std::ofstream routes ((out + "-routes.csv").c_str ());
+  std::ofstream neighbors ((out + "-neighbors.csv").c_str ());
+  routes << "time,node,destination,next_hop,interface,flag,seqno,valid_seqno,hops,etx,lifetime,path_let\n";
+  neighbors << "time,node,neighbor,etx,lpp_bitmap,lpp_reverse,x,y,z,vx,vy,vz\n";
+
+  std::vector<SnapshotRouteRecord> r;
+  std::vector<SnapshotNeighborRecord> n;
+  SnapshotBlockHeader block;
+  uint32_t snapshots = 0;
+  while (file.read (reinterpret_cast<char *> (&block), sizeof (block)))
+    {
+      r.resize (block.routeCount);
+      n.resize (block.neighborCount);
+      if ((block.routeCount
+           && !file.read (reinterpret_cast<char *> (&r[0]), r.size () * sizeof (SnapshotRouteRecord)))
+          || (block.neighborCount
+              && !file.read (reinterpret_cast<char *> (&n[0]), n.size () * sizeof (SnapshotNeighborRecord))))
+        {
+          std::cerr << "Truncated snapshot at " << block.timeNs << " ns, ignored" << std::endl;
+          break;
+        }
+      double t = block.timeNs / 1e9;
+      for (std::vector<SnapshotRouteRecord>::const_iterator i = r.begin (); i != r.end (); ++i)
+        {
+          routes << t << "," << i->nodeId << "," << AddressToString (i->destination)
+                 << "," << AddressToString (i->nextHop) << "," << AddressToString (i->interface)
+                 << "," << FlagToString (i->flag) << "," << i->seqNo << "," << (uint32_t) i->validSeqNo
+                 << "," << i->hops << "," << i->etx << "," << i->lifetimeMs / 1e3
+                 << "," << i->pathLetMs / 1e3 << "\n";
+        }
+      for (std::vector<SnapshotNeighborRecord>::const_iterator i = n.begin (); i != n.end (); ++i)
+        {
+          neighbors << t << "," << i->nodeId << "," << AddressToString (i->neighbor)
+                    << "," << i->etx << "," << i->lppBitmap << "," << (uint32_t) i->lppReverse
+                    << "," << i->position[0] << "," << i->position[1] << "," << i->position[2]
+                    << "," << i->velocity[0] << "," << i->velocity[1] << "," << i->velocity[2] << "\n";
+        }
+      snapshots++;
+    }
+
+  std::cout << "Converted " << snapshots << " snapshots from " << in << " to "
+            << out << "-routes.csv and " << out << "-neighbors.csv" << std::endl;
+  return 0;
+}
@@ -39,6 +39,7 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include <set>
 
 using namespace ns3;
 
@@ -56,6 +57,24 @@ PacketSinkTraceSinkContext (std::string context, Ptr<const Packet> packet, const
   std::cout << "Context = " << context << "; Packet received; UID = " << packet->GetUid () << std::endl;
 }
 
+// Penghitung overhead route discovery AODV
+static std::set<std::pair<Ipv4Address, uint32_t> > g_discoveries; // pasangan (origin, RREQ ID)
+static uint32_t g_rreqForwards = 0;
+static uint32_t g_rrepSends = 0;
+
+void
+RreqForwardTrace (Ipv4Address origin, uint32_t id)
+{
+  g_discoveries.insert (std::make_pair (origin, id));
+  g_rreqForwards++;
+}
+
+void
+RrepSendTrace (Ipv4Address origin, Ipv4Address dst)
+{
+  g_rrepSends++;
+}
+
 
 int 
 main (int argc, char *argv[])
@@ -66,6 +85,7 @@ main (int argc, char *argv[])
   uint32_t numPackets = 10;
   double interval = 0.5; // seconds
   bool verbose = false;
+  bool metricForwardDelay = false;
   uint32_t nNodes = 8;
   std::string protocol = "ns3::UdpSocketFactory"; 
   uint16_t port = 80;
@@ -81,6 +101,7 @@ main (int argc, char *argv[])
   cmd.AddValue ("interval", "interval (seconds) between packets", interval);
   cmd.AddValue ("verbose", "turn on all WifiNetDevice log components", verbose);
   cmd.AddValue ("transport TypeId", "TypeId for socket factory", protocol);
+  cmd.AddValue ("metricForwardDelay", "delay RREQ rebroadcasts by link metric (AODV)", metricForwardDelay);
 
   cmd.Parse (argc, argv);
   // Convert to time object
@@ -93,6 +114,8 @@ main (int argc, char *argv[])
   // Fix non-unicast data rate to be the same as that of unicast
   Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", 
                       StringValue (phyMode));
+  Config::SetDefault ("ns3::aodv::RoutingProtocol::EnableMetricForwardDelay",
+                      BooleanValue (metricForwardDelay));
 
 
   NodeContainer c;
@@ -204,6 +227,8 @@ main (int argc, char *argv[])
   // Tracing
   Config::ConnectWithoutContext ("/NodeList/0/ApplicationList/0/$ns3::PacketSink/Rx", MakeCallback (&PacketSinkTraceSink));
   Config::Connect ("/NodeList/0/ApplicationList/0/$ns3::PacketSink/Rx", MakeCallback (&PacketSinkTraceSinkContext));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/RreqForward", MakeCallback (&RreqForwardTrace));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/RrepSend", MakeCallback (&RrepSendTrace));
   wifiPhy.EnablePcap ("etf-floor", devices);
   
   // Output what we are doing
@@ -263,6 +288,19 @@ main (int argc, char *argv[])
   std::cout << "Total Paket Hilang (Lost)  : " << totalLostPackets << std::endl;
   std::cout << "Packet Delivery Ratio (PDR): " << pdr << " %" << std::endl;
   std::cout << "-----------------------------------------------------------" << std::endl;
+
+  // Overhead route discovery, bandingkan dengan --metricForwardDelay=0 dan =1
+  uint32_t nDiscoveries = g_discoveries.size ();
+  std::cout << "Metric forward delay       : " << (metricForwardDelay ? "aktif" : "nonaktif") << std::endl;
+  std::cout << "Jumlah Discovery (RREQ)    : " << nDiscoveries << std::endl;
+  std::cout << "Total RREQ Diteruskan      : " << g_rreqForwards << std::endl;
+  std::cout << "Total RREP Dikirim         : " << g_rrepSends << std::endl;
+  if (nDiscoveries > 0)
+    {
+      std::cout << "RREQ Diteruskan/Discovery  : " << (double)g_rreqForwards / nDiscoveries << std::endl;
+      std::cout << "RREP Dikirim/Discovery     : " << (double)g_rrepSends / nDiscoveries << std::endl;
+    }
+  std::cout << "-----------------------------------------------------------" << std::endl;
   // -----------------------------------------------------------------
   
   flowMon -> SerializeToXmlFile ("flomon.xml", true, true);